@@ -0,0 +1,29 @@
+# Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+# 
+# This file is part of YASW (Yet Another Scan Wizard).
+# 
+# YASW is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# 
+# YASW is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+
+# Benchmark of the image processing of every filter (see filterbenchmark.h).
+# It only needs the engine, no widget: it can run on a build machine without display.
+QMAKE_CXXFLAGS += -std=c++11
+TARGET = yasw-bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+SOURCES += main.cpp \
+    filterbenchmark.cpp
+HEADERS += filterbenchmark.h
+
+include(../src/engine/engine.pri)
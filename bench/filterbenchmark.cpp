@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filterbenchmark.h"
+#include "filterengine.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QtCore/qmath.h>
+
+void FilterBenchmark::setIterations(int iterations)
+{
+    this->iterations = qMax(1, iterations);
+}
+
+/** \brief Restricts the benchmark to the given stages (see allStages()) */
+void FilterBenchmark::setStages(QStringList stages)
+{
+    this->stages = stages;
+}
+
+/** \brief Measures every stage on a synthetic page of each size in megapixels.
+*/
+QList<BenchmarkResult> FilterBenchmark::run(QList<qreal> megapixels)
+{
+    QList<BenchmarkResult> results;
+    QString stage;
+    qreal size;
+
+    foreach (size, megapixels) {
+        QImage page = syntheticPage(size);
+        foreach (stage, stages) {
+            results.append(measure(stage, page, size));
+        }
+    }
+    return results;
+}
+
+QStringList FilterBenchmark::allStages()
+{
+    return QStringList() << "Rotation" << "Dekeystoning" << "Cropping" << "ScaleFilter"
+                         << "ScaleFast" << "ScaleBest" << "LayoutFilter" << "colorcorrection" << "StagedChain" << "FusedChain";
+}
+
+/** \brief Creates a 3:2 page of about megapixels millions pixels, like a camera image.
+
+  The content (gradients and a grid) only has to be deterministic and not uniform.
+*/
+QImage FilterBenchmark::syntheticPage(qreal megapixels)
+{
+    int height = qRound(qSqrt(megapixels * 1000000 / 1.5));
+    int width = qRound(height * 1.5);
+    QImage page(width, height, QImage::Format_RGB32);
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        QRgb *line = reinterpret_cast<QRgb *>(page.scanLine(y));
+        for (x = 0; x < width; x++) {
+            int ink = ((x / 16) % 8 == 0 || (y / 24) % 6 == 0) ? 160 : 0;
+            line[x] = qRgb(qMax(0, 240 - ink - x * 32 / width),
+                           qMax(0, 235 - ink - y * 32 / height),
+                           qMax(0, 220 - ink));
+        }
+    }
+    return page;
+}
+
+/** \brief Plausible settings for a page of the given size.
+
+  The page is rotated by angle, then a slightly skewed quadrilateral is dekeystoned,
+  5% of each border is cropped, the image is scaled to 80% and centered on a page 10% larger.
+*/
+PageParameters FilterBenchmark::pageParameters(QSize size, int angle)
+{
+    PageParameters parameters;
+
+    parameters.rotation.angle = angle;
+    if (angle % 180 != 0)
+        size.transpose();
+
+    qreal w = size.width();
+    qreal h = size.height();
+    parameters.dekeystoning.polygon << QPointF(0.05 * w, 0.04 * h) << QPointF(0.95 * w, 0.06 * h)
+                                    << QPointF(0.96 * w, 0.95 * h) << QPointF(0.04 * w, 0.96 * h);
+
+    w = parameters.dekeystoning.meanWidth();
+    h = parameters.dekeystoning.meanHeight();
+    parameters.cropping.rectangle = QRect(qRound(0.05 * w), qRound(0.05 * h),
+                                          qRound(0.9 * w), qRound(0.9 * h));
+
+    parameters.scale.pxImageWidth = 0.8 * parameters.cropping.rectangle.width();
+    parameters.scale.pxImageHeight = 0.8 * parameters.cropping.rectangle.height();
+
+    parameters.layout.pxPageWidth = 1.1 * parameters.scale.pxImageWidth;
+    parameters.layout.pxPageHeight = 1.1 * parameters.scale.pxImageHeight;
+
+    parameters.colorCorrection.whitePoint = QColor(235, 235, 230);
+    parameters.colorCorrection.blackPoint = QColor(25, 25, 30);
+
+    return parameters;
+}
+
+BenchmarkResult FilterBenchmark::measure(QString stage, const QImage &page, qreal megapixels)
+{
+    BenchmarkResult result;
+    QElapsedTimer timer;
+    int i;
+
+    // Not timed: the first run allocates memory and loads the code
+    runStage(stage, page);
+
+    timer.start();
+    for (i = 0; i < iterations; i++) {
+        runStage(stage, page);
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+
+    result.stage = stage;
+    result.megapixels = megapixels;
+    result.size = page.size();
+    result.iterations = iterations;
+    result.msPerPage = elapsed / 1000000.0 / iterations;
+    result.mbPerSecond = page.byteCount() / 1000000.0 / (result.msPerPage / 1000);
+    return result;
+}
+
+/* The single stages use settings for the unrotated page, the chains rotate it by 90 degrees
+   as for a book scanned with a camera in landscape position. */
+QImage FilterBenchmark::runStage(QString stage, const QImage &page)
+{
+    PageParameters parameters = pageParameters(page.size(), 0);
+
+    if (stage == "Rotation") {
+        parameters.rotation.angle = 90;
+        return FilterEngine::rotate(page, parameters.rotation);
+    }
+    if (stage == "Dekeystoning")
+        return FilterEngine::dekeystone(page, parameters.dekeystoning);
+    if (stage == "Cropping")
+        return FilterEngine::crop(page, parameters.cropping);
+    if (stage == "ScaleFilter")
+        return FilterEngine::scale(page, parameters.scale);
+    if (stage == "ScaleFast" || stage == "ScaleBest") {
+        parameters.scale.quality = stage == "ScaleFast" ? "Fast" : "Best";
+        return FilterEngine::scale(page, parameters.scale);
+    }
+    if (stage == "LayoutFilter")
+        return FilterEngine::layout(page, parameters.layout);
+    if (stage == "colorcorrection")
+        return FilterEngine::colorCorrect(page, parameters.colorCorrection);
+    if (stage == "StagedChain")
+        return FilterEngine::render(page, pageParameters(page.size(), 90), FilterEngine::StagedRendering);
+    if (stage == "FusedChain")
+        return FilterEngine::render(page, pageParameters(page.size(), 90), FilterEngine::FusedRendering);
+    return page;
+}
+
+QString FilterBenchmark::toText(QList<BenchmarkResult> results)
+{
+    QString text;
+    QTextStream out(&text);
+    BenchmarkResult result;
+
+    out << qSetFieldWidth(16) << left << "stage" << "megapixels" << "ms/page" << "MB/s"
+        << qSetFieldWidth(0) << "\n";
+    foreach (result, results) {
+        out << qSetFieldWidth(16) << left << result.stage
+            << QString::number(result.megapixels)
+            << QString::number(result.msPerPage, 'f', 1)
+            << QString::number(result.mbPerSecond, 'f', 1)
+            << qSetFieldWidth(0) << "\n";
+    }
+    return text;
+}
+
+QString FilterBenchmark::toCsv(QList<BenchmarkResult> results)
+{
+    QString csv = "stage,megapixels,width,height,iterations,ms_per_page,mb_per_s\n";
+    BenchmarkResult result;
+
+    foreach (result, results) {
+        csv += QString("%1,%2,%3,%4,%5,%6,%7\n")
+                .arg(result.stage)
+                .arg(result.megapixels)
+                .arg(result.size.width())
+                .arg(result.size.height())
+                .arg(result.iterations)
+                .arg(result.msPerPage, 0, 'f', 3)
+                .arg(result.mbPerSecond, 0, 'f', 3);
+    }
+    return csv;
+}
+
+QString FilterBenchmark::toJson(QList<BenchmarkResult> results)
+{
+    QJsonArray array;
+    BenchmarkResult result;
+
+    foreach (result, results) {
+        QJsonObject object;
+        object["stage"] = result.stage;
+        object["megapixels"] = result.megapixels;
+        object["width"] = result.size.width();
+        object["height"] = result.size.height();
+        object["iterations"] = result.iterations;
+        object["ms_per_page"] = result.msPerPage;
+        object["mb_per_s"] = result.mbPerSecond;
+        array.append(object);
+    }
+    return QString::fromUtf8(QJsonDocument(array).toJson());
+}
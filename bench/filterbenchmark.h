@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FILTERBENCHMARK_H
+#define FILTERBENCHMARK_H
+
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include "filterparameters.h"
+
+/* Time for one stage on one page size */
+struct BenchmarkResult
+{
+    QString stage;
+    qreal megapixels;
+    QSize size;
+    int iterations;
+    qreal msPerPage;
+    // megabytes (10^6 bytes) of input image processed per second
+    qreal mbPerSecond;
+};
+
+/* Measures the image processing of each filter on synthetic pages.
+
+  The stages are the filter identifiers (see BaseFilter::getIdentifier()); each filter
+  only calls the matching FilterEngine function, which is what is timed here, without any
+  widget. "StagedChain" is the whole chain as computed by the FilterContainer, and
+  "FusedChain" the chain as computed for export (FilterEngine::FusedRendering).
+
+  The results can be written as text, CSV or JSON, so that a build machine can compare
+  them with the results of the previous build.
+*/
+class FilterBenchmark
+{
+public:
+    void setIterations(int iterations);
+    void setStages(QStringList stages);
+    QList<BenchmarkResult> run(QList<qreal> megapixels);
+
+    static QStringList allStages();
+    static QImage syntheticPage(qreal megapixels);
+    static PageParameters pageParameters(QSize size, int angle);
+
+    static QString toText(QList<BenchmarkResult> results);
+    static QString toCsv(QList<BenchmarkResult> results);
+    static QString toJson(QList<BenchmarkResult> results);
+
+private:
+    BenchmarkResult measure(QString stage, const QImage &page, qreal megapixels);
+    static QImage runStage(QString stage, const QImage &page);
+
+    int iterations = 3;
+    QStringList stages = allStages();
+};
+
+#endif // FILTERBENCHMARK_H
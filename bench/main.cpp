@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include "filterbenchmark.h"
+
+/* yasw-bench [--format text|csv|json] [--iterations n] [--megapixels 12,24,50] [--stages ...]
+   Prints the time of each filter on synthetic pages on the standard output. */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("yasw-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the image processing of the YASW filters");
+    parser.addHelpOption();
+    QCommandLineOption formatOption("format", "Output format: text, csv or json.", "format", "text");
+    QCommandLineOption iterationsOption("iterations", "Timed runs of each stage.", "n", "3");
+    QCommandLineOption megapixelsOption("megapixels", "Comma separated page sizes.", "sizes", "12,24,50");
+    QCommandLineOption stagesOption("stages", "Comma separated stages (default: all).", "stages",
+                                    FilterBenchmark::allStages().join(","));
+    parser.addOption(formatOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(megapixelsOption);
+    parser.addOption(stagesOption);
+    parser.process(app);
+
+    QList<qreal> megapixels;
+    QString size;
+    foreach (size, parser.value(megapixelsOption).split(",", QString::SkipEmptyParts)) {
+        megapixels.append(size.toDouble());
+    }
+
+    FilterBenchmark benchmark;
+    benchmark.setIterations(parser.value(iterationsOption).toInt());
+    benchmark.setStages(parser.value(stagesOption).split(",", QString::SkipEmptyParts));
+    QList<BenchmarkResult> results = benchmark.run(megapixels);
+
+    QTextStream out(stdout);
+    QString format = parser.value(formatOption);
+    if (format == "csv")
+        out << FilterBenchmark::toCsv(results);
+    else if (format == "json")
+        out << FilterBenchmark::toJson(results);
+    else
+        out << FilterBenchmark::toText(results);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batchexport.h"
+#include "constants.h"
+#include "projectreader.h"
+#include "pageexporter.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <cstring>
+
+/** \brief Returns true if the command line asks for a headless export.
+
+  This is checked before any QCoreApplication exists, to choose which application to create.
+*/
+bool BatchExport::isBatchMode(int argc, char *argv[])
+{
+    int i;
+    for (i = 1; i < argc; i++) {
+        // QCommandLineParser also accepts the value after "=" (--export-pdf=book.pdf)
+        if (strcmp(argv[i], "--export-pdf") == 0 || strcmp(argv[i], "--export-dir") == 0
+                || strncmp(argv[i], "--export-pdf=", 13) == 0 || strncmp(argv[i], "--export-dir=", 13) == 0)
+            return true;
+    }
+    return false;
+}
+
+/** \brief Exports the project given on the command line.
+
+  All arguments are checked before the first page is exported.
+
+  @returns the exit code of the application: 0 on success, 1 if the project could not be
+  read or a page could not be exported, 2 on wrong arguments.
+*/
+int BatchExport::run(QStringList arguments)
+{
+    QTextStream err(stderr);
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Yet Another Scan Wizard - export a project without GUI");
+    parser.addHelpOption();
+    parser.addPositionalArgument("project", "The .yasw project to export.");
+    QCommandLineOption pdfOption("export-pdf", "Export all pages into <file>.", "file");
+    QCommandLineOption dirOption("export-dir", "Export all pages as JPEG into <folder>.", "folder");
+    QCommandLineOption dpiOption("dpi", "Resolution of the PDF (default: DPI of the project).", "dpi");
+    QCommandLineOption jobsOption("jobs", "Number of pages computed at the same time.", "pages");
+    QCommandLineOption losslessOption("lossless", "Compress the PDF pages without loss (bigger files).");
+    parser.addOption(pdfOption);
+    parser.addOption(dirOption);
+    parser.addOption(dpiOption);
+    parser.addOption(jobsOption);
+    parser.addOption(losslessOption);
+    parser.process(arguments);
+
+    // Check every argument before exporting anything: a mistake must not cost a full export.
+    if (parser.positionalArguments().size() != 1) {
+        err << "yasw: exactly one project file expected" << endl;
+        return 2;
+    }
+    QString projectFile = parser.positionalArguments().first();
+
+    int jobs = 0;
+    if (parser.isSet(jobsOption)) {
+        bool ok;
+        jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            err << "yasw: invalid number of jobs " << parser.value(jobsOption) << endl;
+            return 2;
+        }
+    }
+
+    int dpi = 0;
+    if (parser.isSet(dpiOption)) {
+        bool ok;
+        dpi = parser.value(dpiOption).toInt(&ok);
+        if (!ok || dpi < Constants::MIN_DPI) {
+            err << "yasw: invalid DPI " << parser.value(dpiOption) << endl;
+            return 2;
+        }
+    }
+
+    if (parser.isSet(dirOption) && !QFileInfo(parser.value(dirOption)).isDir()) {
+        err << "yasw: no such folder " << parser.value(dirOption) << endl;
+        return 2;
+    }
+
+    if (parser.isSet(pdfOption)) {
+        QFileInfo pdfFile(parser.value(pdfOption));
+        if (parser.value(pdfOption).isEmpty() || pdfFile.isDir() || !pdfFile.absoluteDir().exists()) {
+            err << "yasw: cannot write the PDF to " << parser.value(pdfOption) << endl;
+            return 2;
+        }
+    }
+
+    ProjectReader project;
+    if (!project.load(projectFile)) {
+        err << "yasw: " << project.errorString() << endl;
+        return 1;
+    }
+
+    if (parser.isSet(pdfOption) && !parser.isSet(dpiOption)) {
+        dpi = project.DPI();
+        if (dpi < Constants::MIN_DPI) {
+            err << "yasw: invalid DPI " << dpi << " in " << projectFile << endl;
+            return 1;
+        }
+    }
+
+    PageExporter exporter;
+    if (jobs > 0)
+        exporter.setMaxConcurrentPages(jobs);
+    if (parser.isSet(losslessOption))
+        exporter.setPdfCompression(PdfWriter::FlateCompression);
+    connect(&exporter, SIGNAL(progress(int)),
+            this, SLOT(pageExported(int)));
+
+    bool exportOK = true;
+
+    if (parser.isSet(dirOption)) {
+        QList<ExportPage> pages = project.leftPages() + project.rightPages();
+        pageCount = pages.size();
+        exportOK = exporter.exportToFolder(pages, parser.value(dirOption)) && exportOK;
+    }
+
+    if (parser.isSet(pdfOption)) {
+        QList<ExportPage> pages = PageExporter::interleave(project.leftPages(), project.rightPages());
+        pageCount = pages.size();
+        exportOK = exporter.exportToPdf(pages, parser.value(pdfOption), dpi) && exportOK;
+    }
+
+    return exportOK ? 0 : 1;
+}
+
+void BatchExport::pageExported(int pages)
+{
+    QTextStream out(stdout);
+    out << "Page " << pages << "/" << pageCount << endl;
+}
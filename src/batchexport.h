@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+#include <QObject>
+#include <QStringList>
+
+/* Headless export of a project, used when yasw is started with --export-pdf or --export-dir.
+
+  It runs in a QCoreApplication: no widget is created and no display is needed, so several
+  exports can run at the same time on a machine without X server.
+  The project is read with ProjectReader and the pages are computed by PageExporter,
+  exactly as the "Export" actions of the GUI do it.
+*/
+class BatchExport : public QObject
+{
+    Q_OBJECT
+public:
+    static bool isBatchMode(int argc, char *argv[]);
+    int run(QStringList arguments);
+
+private slots:
+    void pageExported(int pages);
+
+private:
+    int pageCount = 0;
+};
+
+#endif // BATCHEXPORT_H
@@ -35,16 +35,28 @@ QStringList Constants::horizontalAlignment = QStringList() << "Left"
 QStringList Constants::verticalAlignment = QStringList() << "Top"
                                                   << "Center"
                                                   << "Bottom";
+QStringList Constants::scaleQuality = QStringList() << "Fast"
+                                                  << "Smooth"
+                                                  << "Best";
 
-QRegExp Constants::trailZero = QRegExp("0+$");
-QRegExp Constants::trailDot = QRegExp("\\.$");
 
+/** \brief Formats n with at most precision decimals, without trailing zeros ("2.50" -> "2.5").
 
+  Called for every number of a saved project, so the zeros are cut by hand instead of with
+  regular expressions.
+*/
 QString Constants::float2String(qreal n, int precision)
 {
     QString str = QString::number(n, 'f', precision);
-    str.remove(trailZero);
-    str.remove(trailDot);
+    if (precision <= 0)
+        return str;
+
+    int length = str.size();
+    while (str.at(length - 1) == QLatin1Char('0'))
+        length--;
+    if (str.at(length - 1) == QLatin1Char('.'))
+        length--;
+    str.truncate(length);
 
     return str;
 }
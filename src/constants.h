@@ -35,6 +35,14 @@ public:
 
     static int const MIN_DPI = 10;
     static int const DEFAULT_DPI = 300;
+    // Smallest edge (in device pixels) of the proxy images used for the interactive preview
+    static int const MIN_PROXY_SIZE = 512;
+    // Source images larger than this (in megapixels) are rendered band by band on export
+    static int const STREAMED_MIN_MEGAPIXELS = 48;
+    // Memory (in MB) for the part of the source image read for one band
+    static int const STREAMED_BAND_SIZE = 64;
+    // Quality (0-100) of the JPEG images written on export
+    static int const EXPORT_JPEG_QUALITY = 90;
 
     // Constants for Layout Filter & Widget
     enum horizintalAlignmentEnum {LeftHAlignment, CenterHAlignment, RightHAlignment};
@@ -42,12 +50,11 @@ public:
     static QStringList horizontalAlignment;
     static QStringList verticalAlignment;
 
-    static QString float2String(qreal n, int precision = 2);
+    // Constants for Scale Filter & Widget: how the image is resampled (see Resampler)
+    enum scaleQualityEnum {FastScaleQuality, SmoothScaleQuality, BestScaleQuality};
+    static QStringList scaleQuality;
 
-private:
-    // Code optimisation: define these QRegExp once and loading a project is much faster.
-    static QRegExp trailZero;
-    static QRegExp trailDot;
+    static QString float2String(qreal n, int precision = 2);
 };
 
 
@@ -0,0 +1,34 @@
+# Widget-free image processing of YASW (see filterengine.h).
+# Included by yasw.pro and by every other target that needs to compute pages.
+QT += concurrent
+INCLUDEPATH += $$PWD \
+    $$PWD/..
+DEPENDPATH += $$PWD
+SOURCES += $$PWD/filterparameters.cpp \
+    $$PWD/filterengine.cpp \
+    $$PWD/imagewarp.cpp \
+    $$PWD/resampler.cpp \
+    $$PWD/pageexporter.cpp \
+    $$PWD/imagecache.cpp \
+    $$PWD/thumbnailloader.cpp \
+    $$PWD/pageprefetcher.cpp \
+    $$PWD/projectreader.cpp \
+    $$PWD/projectwriter.cpp \
+    $$PWD/pdfwriter.cpp \
+    $$PWD/framepool.cpp \
+    $$PWD/stagelog.cpp \
+    $$PWD/../constants.cpp
+HEADERS += $$PWD/filterparameters.h \
+    $$PWD/filterengine.h \
+    $$PWD/imagewarp.h \
+    $$PWD/resampler.h \
+    $$PWD/pageexporter.h \
+    $$PWD/imagecache.h \
+    $$PWD/thumbnailloader.h \
+    $$PWD/pageprefetcher.h \
+    $$PWD/projectreader.h \
+    $$PWD/projectwriter.h \
+    $$PWD/pdfwriter.h \
+    $$PWD/framepool.h \
+    $$PWD/stagelog.h \
+    $$PWD/../constants.h
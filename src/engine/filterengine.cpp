@@ -0,0 +1,730 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filterengine.h"
+#include "imagewarp.h"
+#include "resampler.h"
+#include "framepool.h"
+#include "constants.h"
+
+#include <QTransform>
+#include <cstring>
+#include <QPainter>
+#include <QImageReader>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+
+QImage FilterEngine::rotate(const QImage &inputImage, const RotationParameters &parameters)
+{
+    if (!parameters.enabled)
+        return inputImage;
+
+    QTransform rotationMatrix;
+    rotationMatrix.rotate(parameters.angle);
+    return inputImage.transformed(rotationMatrix);
+}
+
+QImage FilterEngine::dekeystone(const QImage &inputImage, const DekeystoningParameters &parameters)
+{
+    if (!parameters.enabled)
+        return inputImage;
+
+    QTransform transformMatrix;
+    /* it might not be possbible to calculate a treansformation matrix */
+    if (!QTransform::quadToSquare(parameters.polygon, transformMatrix)) {
+        qDebug() << "No transformation exists for this";
+        return QImage();
+    }
+
+    /* As transformMatrix transforms the polygon to a unit square (1px * 1px), we have
+     * to scale it back to the size of our rectangle selection. We use the mean size of
+     * the Rectangle as a reference. */
+    QTransform scaleMatrix = QTransform::fromScale(parameters.meanWidth(), parameters.meanHeight());
+    QTransform matrix = transformMatrix * scaleMatrix;
+
+    /* The image keeps the size and placement QImage::transformed() gives it, as the cropping
+     * rectangle is relative to them, but only the selection is computed: the rest of the
+     * transformed image is transparent. */
+    QTransform placedMatrix = QImage::trueMatrix(matrix, inputImage.width(), inputImage.height());
+    QRect selection = placedMatrix.map(parameters.polygon).boundingRect().toAlignedRect();
+
+    return ImageWarp::warp(inputImage, placedMatrix, transformedSize(matrix, inputImage.size()), selection);
+}
+
+QImage FilterEngine::crop(const QImage &inputImage, const CroppingParameters &parameters)
+{
+    if (!parameters.enabled)
+        return inputImage;
+
+    QRect rectangle = parameters.rectangle;
+    // QImage::copy() also handles rectangles outside of the image and all pixel depths.
+    if (inputImage.depth() != 32 || !inputImage.rect().contains(rectangle) || rectangle.isEmpty())
+        return inputImage.copy(rectangle);
+
+    QImage outputImage = FramePool::globalInstance()->allocate(rectangle.size(), inputImage.format());
+    if (outputImage.isNull())
+        return outputImage;
+    outputImage.setDotsPerMeterX(inputImage.dotsPerMeterX());
+    outputImage.setDotsPerMeterY(inputImage.dotsPerMeterY());
+    for (int y = 0; y < rectangle.height(); y++)
+        memcpy(outputImage.scanLine(y), inputImage.constScanLine(rectangle.y() + y) + rectangle.x() * 4,
+               rectangle.width() * 4);
+    return outputImage;
+}
+
+QImage FilterEngine::scale(const QImage &inputImage, const ScaleParameters &parameters)
+{
+    if (!parameters.enabled)
+        return inputImage;
+
+    qreal imageWidth = parameters.pxImageWidth;
+    qreal imageHeight = parameters.pxImageHeight;
+
+    // Size not set yet: the widget would use the input image size.
+    if (imageWidth == 0 && imageHeight == 0)
+        return inputImage;
+
+    if (imageWidth == 0 || imageHeight == 0 || inputImage.isNull()) {
+        return QImage();
+    }
+
+    QSize outputImageSize = QSize(imageWidth, imageHeight);
+    switch (Constants::scaleQuality.indexOf(parameters.quality)) {
+    case Constants::SmoothScaleQuality:
+        return Resampler::resize(inputImage, outputImageSize, Resampler::BicubicFilter);
+    case Constants::BestScaleQuality:
+        return Resampler::resize(inputImage, outputImageSize, Resampler::Lanczos3Filter);
+    }
+    // Fast, or unknown quality: nearest neighbour
+    return inputImage.scaled(outputImageSize);
+}
+
+QImage FilterEngine::layout(const QImage &inputImage, const LayoutParameters &parameters)
+{
+    if (!parameters.enabled)
+        return inputImage;
+
+    if (inputImage.isNull())
+        return QImage();
+
+    qreal imageWidth = inputImage.width();
+    qreal imageHeight = inputImage.height();
+
+    qreal pageWidth = parameters.pxPageWidth;
+    qreal pageHeight = parameters.pxPageHeight;
+
+    // Size not set yet: the widget would use the input image size.
+    if (pageWidth == 0 && pageHeight == 0) {
+        pageWidth = imageWidth;
+        pageHeight = imageHeight;
+    }
+
+    if (pageWidth == 0 || pageHeight == 0) {
+        return QImage();
+    }
+
+    QPoint offset = layoutOffset(inputImage.size(), QSizeF(pageWidth, pageHeight), parameters);
+
+    QImage page = FramePool::globalInstance()->allocate(QSize(pageWidth, pageHeight),
+                                                        QImage::Format_ARGB32_Premultiplied);
+    if (page.isNull())
+        return page;
+    //NOTE: fill color could be a parameter. I do wait for user feedback ;-)
+    page.fill(Qt::white);
+    QPainter painter(&page);
+    painter.drawImage(offset, inputImage);
+    return page;
+}
+
+/** \brief Position of the image on the page, depending on the alignement.
+
+  The image is never moved out of the page on the top or left side.
+*/
+QPoint FilterEngine::layoutOffset(QSize imageSize, QSizeF pageSize, const LayoutParameters &parameters)
+{
+    qreal imageWidth = imageSize.width();
+    qreal imageHeight = imageSize.height();
+    qreal pageWidth = pageSize.width();
+    qreal pageHeight = pageSize.height();
+    qreal leftMargin = 0;
+    qreal topMargin = 0;
+
+    // indexOf returns -1 if the alignement is unknown. In this case, margin = 0;
+    switch (Constants::horizontalAlignment.indexOf(parameters.horizontalAlignement)) {
+    case Constants::LeftHAlignment:
+        leftMargin = 0;
+        break;
+    case Constants::CenterHAlignment:
+        leftMargin = qMax((pageWidth - imageWidth) / 2, (qreal)0.0);
+        break;
+    case Constants::RightHAlignment:
+        leftMargin = qMax(pageWidth - imageWidth, (qreal)0.0);
+        break;
+    }
+    switch (Constants::verticalAlignment.indexOf(parameters.verticalAlignement)) {
+    case Constants::TopVAlignment:
+        topMargin = 0;
+        break;
+    case Constants::CenterVAlignment:
+        topMargin = qMax((pageHeight - imageHeight) / 2, (qreal)0.0);
+        break;
+    case Constants::BottomVAlignment:
+        topMargin = qMax(pageHeight - imageHeight, (qreal)0.0);
+        break;
+    }
+
+    // QPainter::drawImage(int, int, ...) used to truncate the margins
+    return QPoint(int(leftMargin), int(topMargin));
+}
+
+/* What the bands of colorCorrect() share. The output pixels are taken once in the calling
+   thread: QImage::scanLine() may detach the image, which is not thread safe. */
+struct ColorCorrectionJob
+{
+    const QImage *inputImage;
+    uchar *outputBits;
+    int outputBytesPerLine;
+    const uint *lut;
+};
+
+// Applies the color lookup tables to the rows [firstRow, lastRow[ of the input image.
+// Runs in a worker thread: each thread writes its own rows of the output.
+static void colorCorrectRows(const ColorCorrectionJob *job, int firstRow, int lastRow)
+{
+    int x, y;
+    int width = job->inputImage->width();
+    const uint *redLut = job->lut;
+    const uint *greenLut = job->lut + 256;
+    const uint *blueLut = job->lut + 512;
+
+    for (y = firstRow; y < lastRow; y++) {
+        const uint *in = reinterpret_cast<const uint *>(job->inputImage->constScanLine(y));
+        uint *out = reinterpret_cast<uint *>(job->outputBits + y * job->outputBytesPerLine);
+        for (x = 0; x < width; x++) {
+            uint pixel = in[x];
+            out[x] = 0xff000000
+                    | redLut[(pixel >> 16) & 0xff]
+                    | greenLut[(pixel >> 8) & 0xff]
+                    | blueLut[pixel & 0xff];
+        }
+    }
+}
+
+/** \brief Stretches the colors so that blackPoint becomes black and whitePoint white.
+
+  The new value of each channel only depends on its old value, so it is taken from a table of
+  256 entries per channel, computed once; the rows are then processed by all processor cores.
+  The tables are shifted to the position of their channel, so a pixel costs three lookups and
+  two ORs, without any division. The result is opaque.
+*/
+QImage FilterEngine::colorCorrect(const QImage &inputImage, const ColorCorrectionParameters &parameters)
+{
+    if (!parameters.enabled || inputImage.isNull())
+        return inputImage;
+
+    int white[3] = { parameters.whitePoint.red(), parameters.whitePoint.green(), parameters.whitePoint.blue() };
+    int black[3] = { parameters.blackPoint.red(), parameters.blackPoint.green(), parameters.blackPoint.blue() };
+    uint lut[3 * 256];
+    bool identity = true;
+    int channel, value;
+
+    for (channel = 0; channel < 3; channel++) {
+        // as we divide through delta, it must at least be 1.
+        int delta = qMax(1, white[channel] - black[channel]);
+        int shift = 16 - 8 * channel;
+        for (value = 0; value < 256; value++) {
+            int newValue = qMax(0, qMin(255, value * 255 / delta - black[channel]));
+            identity = identity && (newValue == value);
+            lut[channel * 256 + value] = uint(newValue) << shift;
+        }
+    }
+    // Default settings (white and black): nothing to do.
+    if (identity && !inputImage.hasAlphaChannel())
+        return inputImage;
+
+    // The tables work on unpremultiplied colors, as QImage::pixel() returns them.
+    QImage image = inputImage;
+    if (image.format() != QImage::Format_RGB32 && image.format() != QImage::Format_ARGB32)
+        image = image.convertToFormat(QImage::Format_ARGB32);
+
+    QImage outputImage = FramePool::globalInstance()->allocate(image.size(), QImage::Format_ARGB32_Premultiplied);
+    if (outputImage.isNull())
+        return outputImage;
+
+    ColorCorrectionJob job;
+    job.inputImage = &image;
+    job.outputBits = outputImage.bits();
+    job.outputBytesPerLine = outputImage.bytesPerLine();
+    job.lut = lut;
+
+    int bands = qMin(image.height(), qMax(1, QThread::idealThreadCount()));
+    QList<QFuture<void> > running;
+    int band;
+    for (band = 1; band < bands; band++) {
+        running.append(QtConcurrent::run(colorCorrectRows, &job,
+                                         image.height() * band / bands,
+                                         image.height() * (band + 1) / bands));
+    }
+    // The first band is computed in this thread
+    colorCorrectRows(&job, 0, image.height() / bands);
+    foreach (QFuture<void> future, running)
+        future.waitForFinished();
+
+    return outputImage;
+}
+
+/** \brief Applies the filter with the given identifier (see BaseFilter::getIdentifier()).
+
+  settings are the settings of this filter only. inputImage may be a proxy of the scanned image
+  reduced by proxyScale; the settings are then scaled the same way.
+  Unknown identifiers return the input image.
+*/
+QImage FilterEngine::renderStage(QString identifier, const QImage &inputImage,
+                                 const QMap<QString, QVariant> &settings, qreal proxyScale)
+{
+    FramePool::Stage stage(identifier);
+
+    if (identifier == "Rotation")
+        return rotate(inputImage, RotationParameters::fromSettings(settings));
+    if (identifier == "Dekeystoning")
+        return dekeystone(inputImage, DekeystoningParameters::fromSettings(settings).scaled(proxyScale));
+    if (identifier == "Cropping")
+        return crop(inputImage, CroppingParameters::fromSettings(settings).scaled(proxyScale));
+    if (identifier == "ScaleFilter")
+        return scale(inputImage, ScaleParameters::fromSettings(settings).scaled(proxyScale));
+    if (identifier == "LayoutFilter")
+        return layout(inputImage, LayoutParameters::fromSettings(settings).scaled(proxyScale));
+    if (identifier == "colorcorrection")
+        return colorCorrect(inputImage, ColorCorrectionParameters::fromSettings(settings));
+    return inputImage;
+}
+
+/** \brief Factor to reduce an image of imageSize so that it fits in viewSize (device pixels).
+
+  Images smaller than the view are not enlarged (1 is returned).
+*/
+qreal FilterEngine::proxyScale(QSize imageSize, QSizeF viewSize)
+{
+    if (imageSize.isEmpty() || viewSize.isEmpty())
+        return 1.0;
+
+    qreal scale = qMin(viewSize.width() / imageSize.width(),
+                       viewSize.height() / imageSize.height());
+    return qMin(scale, qreal(1.0));
+}
+
+/** \brief Returns image reduced by scale, or image itself if scale is 1 or more. */
+QImage FilterEngine::proxyImage(const QImage &image, qreal scale)
+{
+    if (scale >= 1 || image.isNull())
+        return image;
+
+    return image.scaled(qRound(image.width() * scale), qRound(image.height() * scale),
+                        Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+/** \brief Computes the resulting page from its source image.
+
+  The filters are applied in the same order as in the FilterContainer.
+  ColorCorrection does not change the geometry: it is applied on the resulting page.
+*/
+QImage FilterEngine::render(const QImage &source, const PageParameters &parameters, RenderMode mode)
+{
+    // The source is already in memory: StreamedRendering has nothing to save.
+    if (mode != StagedRendering) {
+        // The fused warp interpolates bilinearly, which aliases large reductions.
+        if (resamplesScale(parameters)) {
+            QImage image = render(source, withoutScale(parameters), mode);
+            image = layout(scale(image, parameters.scale), parameters.layout);
+            return colorCorrect(image, parameters.colorCorrection);
+        }
+
+        // Quarter turns and crops only move pixels: copy them instead of resampling.
+        PageGeometry geometry = pageGeometry(source.size(), parameters);
+        if (exactGeometry(geometry, source.size()))
+            return colorCorrect(renderExact(source, geometry), parameters.colorCorrection);
+
+        QImage page = renderFused(source, parameters);
+        if (!page.isNull())
+            return colorCorrect(page, parameters.colorCorrection);
+        // Fall back to the stages if the geometry can not be combined.
+    }
+
+    QImage image = source;
+
+    image = rotate(image, parameters.rotation);
+    image = dekeystone(image, parameters.dekeystoning);
+    image = crop(image, parameters.cropping);
+    image = scale(image, parameters.scale);
+    image = layout(image, parameters.layout);
+    image = colorCorrect(image, parameters.colorCorrection);
+
+    return image;
+}
+
+/** \brief Loads fileName and computes the resulting page with the given page settings.
+
+  settings are the page settings as stored by ImageTableWidget (see FilterContainer::getSettings()).
+  With FusedRendering, large images (see isLargeImage()) are streamed, so that the whole source
+  image never needs to be in memory.
+*/
+QImage FilterEngine::render(QString fileName, const QMap<QString, QVariant> &settings, RenderMode mode)
+{
+    return render(fileName, PageParameters::fromSettings(settings), mode);
+}
+
+/** \brief Loads fileName and computes the resulting page with the given parameters (see above). */
+QImage FilterEngine::render(QString fileName, const PageParameters &parameters, RenderMode mode)
+{
+    // As for images in memory, the scale filter is computed after the other geometric filters.
+    if (mode != StagedRendering && resamplesScale(parameters)) {
+        QImage image = render(fileName, withoutScale(parameters), mode);
+        image = layout(scale(image, parameters.scale), parameters.layout);
+        return colorCorrect(image, parameters.colorCorrection);
+    }
+
+    if (mode == StreamedRendering || (mode == FusedRendering && isLargeImage(fileName))) {
+        QImage page = renderStreamed(fileName, parameters);
+        if (!page.isNull())
+            return page;
+        // The file format can not be read in parts, or the geometry can not be combined.
+        mode = FusedRendering;
+    }
+
+    return render(QImage(fileName), parameters, mode);
+}
+
+/** \brief true if the scale filter resizes the image with the Resampler (see ScaleParameters::quality) */
+bool FilterEngine::resamplesScale(const PageParameters &parameters)
+{
+    return parameters.scale.enabled
+            && (parameters.scale.pxImageWidth != 0 || parameters.scale.pxImageHeight != 0)
+            && Constants::scaleQuality.indexOf(parameters.scale.quality) != Constants::FastScaleQuality
+            && Constants::scaleQuality.contains(parameters.scale.quality);
+}
+
+/** \brief parameters with the filters computed after the scale filter (included) disabled */
+PageParameters FilterEngine::withoutScale(const PageParameters &parameters)
+{
+    PageParameters geometry = parameters;
+
+    geometry.scale.enabled = false;
+    geometry.layout.enabled = false;
+    geometry.colorCorrection.enabled = false;
+    return geometry;
+}
+
+/** \brief true if the image in fileName is large enough to be rendered band by band
+  (see Constants::STREAMED_MIN_MEGAPIXELS).
+*/
+bool FilterEngine::isLargeImage(QString fileName)
+{
+    QSize size = QImageReader(fileName).size();
+    return (qint64) size.width() * size.height() > (qint64) Constants::STREAMED_MIN_MEGAPIXELS * 1000000;
+}
+
+/** \brief Size of an image of the given size after QImage::transformed(matrix)
+
+  This is the size of the bounding rectangle of the transformed image, as Qt calculates it.
+*/
+QSize FilterEngine::transformedSize(const QTransform &matrix, QSize size)
+{
+    QPolygonF polygon = matrix.map(QPolygonF(QRectF(QPointF(0, 0), size)));
+    return polygon.boundingRect().toAlignedRect().size();
+}
+
+/** \brief Combines the geometric filters into one transformation.
+
+  Each stage transformation is the one QImage::transformed(), QImage::copy() or QPainter::drawImage()
+  would apply in the staged rendering (including the translation QImage::transformed() does to move
+  the result to the origin), so both render modes produce pages of the same size and position.
+  The geometry is not valid if a filter would produce a null image.
+*/
+PageGeometry FilterEngine::pageGeometry(QSize sourceSize, const PageParameters &parameters)
+{
+    PageGeometry geometry;
+    QTransform transform;
+    QTransform matrix;
+    QSize size = sourceSize;
+    // The part of the image that is computed (see dekeystone()), in the coordinates of the current stage
+    QRectF selection;
+
+    if (size.isEmpty())
+        return geometry;
+
+    if (parameters.rotation.enabled) {
+        matrix.reset();
+        matrix.rotate(parameters.rotation.angle);
+        transform *= QImage::trueMatrix(matrix, size.width(), size.height());
+        size = transformedSize(matrix, size);
+    }
+
+    if (parameters.dekeystoning.enabled) {
+        if (!QTransform::quadToSquare(parameters.dekeystoning.polygon, matrix))
+            return geometry;
+        matrix *= QTransform::fromScale(parameters.dekeystoning.meanWidth(),
+                                        parameters.dekeystoning.meanHeight());
+        QTransform placedMatrix = QImage::trueMatrix(matrix, size.width(), size.height());
+        transform *= placedMatrix;
+        selection = QRectF(placedMatrix.map(parameters.dekeystoning.polygon).boundingRect().toAlignedRect());
+        size = transformedSize(matrix, size);
+    }
+
+    if (parameters.cropping.enabled) {
+        QRect rectangle = parameters.cropping.rectangle;
+        transform *= QTransform::fromTranslate(-rectangle.x(), -rectangle.y());
+        selection.translate(-rectangle.x(), -rectangle.y());
+        size = rectangle.size();
+    }
+
+    if (size.isEmpty())
+        return geometry;
+
+    if (parameters.scale.enabled
+            && (parameters.scale.pxImageWidth != 0 || parameters.scale.pxImageHeight != 0)) {
+        QSize scaledSize = QSize(parameters.scale.pxImageWidth, parameters.scale.pxImageHeight);
+        if (scaledSize.isEmpty())
+            return geometry;
+        QTransform scaleMatrix = QTransform::fromScale((qreal) scaledSize.width() / size.width(),
+                                                       (qreal) scaledSize.height() / size.height());
+        transform *= scaleMatrix;
+        selection = scaleMatrix.mapRect(selection);
+        size = scaledSize;
+    }
+
+    geometry.pageSize = size;
+    geometry.imageRect = QRect(QPoint(0, 0), size);
+    if (parameters.dekeystoning.enabled)
+        geometry.imageRect &= selection.toAlignedRect();
+    // Best quality: the fused warp interpolates bicubically
+    geometry.bicubic = Constants::scaleQuality.indexOf(parameters.scale.quality) == Constants::BestScaleQuality;
+
+    if (parameters.layout.enabled) {
+        QSizeF pageSizeF = QSizeF(parameters.layout.pxPageWidth, parameters.layout.pxPageHeight);
+        if (pageSizeF.width() == 0 && pageSizeF.height() == 0)
+            pageSizeF = size;
+        QSize pageSize = QSize(pageSizeF.width(), pageSizeF.height());
+        if (pageSize.isEmpty())
+            return geometry;
+        QPoint offset = layoutOffset(size, pageSizeF, parameters.layout);
+        transform *= QTransform::fromTranslate(offset.x(), offset.y());
+        geometry.pageSize = pageSize;
+        geometry.imageRect.translate(offset);
+        geometry.whiteBackground = true;
+    }
+
+    geometry.transform = transform;
+    geometry.valid = transform.isInvertible();
+    return geometry;
+}
+
+/** \brief Computes the page with a single resampling of the source image.
+
+  @returns a null image if the geometry is not valid (see pageGeometry()).
+*/
+QImage FilterEngine::renderFused(const QImage &source, const PageParameters &parameters)
+{
+    PageGeometry geometry = pageGeometry(source.size(), parameters);
+
+    if (!geometry.valid)
+        return QImage();
+
+    return ImageWarp::warp(source, geometry.transform, geometry.pageSize, geometry.imageRect,
+                           geometry.whiteBackground ? Qt::white : Qt::transparent,
+                           geometry.bicubic ? ImageWarp::BicubicInterpolation : ImageWarp::BilinearInterpolation);
+}
+
+/** \brief Computes the page like renderFused(), without loading the whole source image.
+
+  The page is computed in bands. For each band, only the part of the source image that lands
+  on it is read from fileName (QImageReader::setClipRect()), resampled with ImageWarp and
+  color corrected. About bandSize MB of the source image are read at once, so the memory
+  needed is the resulting page plus one band, instead of the source image and the
+  copies made by the stages.
+
+  Bands are cut along the source rows: after a quarter turn the page is cut in columns,
+  so that each band needs only a few source rows.
+
+  @returns a null image if the file format can not read parts of an image (only formats
+  like JPEG decode a clip rectangle without decoding the whole image) or if the
+  geometry is not valid (see pageGeometry()).
+*/
+QImage FilterEngine::renderStreamed(QString fileName, const PageParameters &parameters, int bandSize)
+{
+    QImageReader sourceReader(fileName);
+    if (!sourceReader.supportsOption(QImageIOHandler::ClipRect))
+        return QImage();
+
+    QSize sourceSize = sourceReader.size();
+    QRect sourceBounds = QRect(QPoint(0, 0), sourceSize);
+    PageGeometry geometry = pageGeometry(sourceSize, parameters);
+    if (!geometry.valid)
+        return QImage();
+
+    QTransform toSource = geometry.transform.inverted();
+    QSize pageSize = geometry.pageSize;
+    QPointF center = QPointF(pageSize.width() / 2.0, pageSize.height() / 2.0);
+    QPointF origin = toSource.map(center);
+    // Source rows covered by one page column / one page row, around the center of the page
+    qreal rowsAlongX = qAbs(toSource.map(center + QPointF(1, 0)).y() - origin.y());
+    qreal rowsAlongY = qAbs(toSource.map(center + QPointF(0, 1)).y() - origin.y());
+    bool columns = rowsAlongX > rowsAlongY;
+
+    int extent = columns ? pageSize.width() : pageSize.height();
+    int length = columns ? pageSize.height() : pageSize.width();
+    qreal rowsPerLine = qMax(columns ? rowsAlongX : rowsAlongY, 0.001);
+    // A rotated band also covers the source rows crossed along its length.
+    qreal skewRows = length * (columns ? rowsAlongY : rowsAlongX) + 4;
+    qreal budgetRows = (qreal) bandSize * 1024 * 1024 / (4.0 * qMax(1, sourceSize.width()));
+    int thickness = qBound(16, (int) ((budgetRows - skewRows) / rowsPerLine), qMax(16, extent));
+
+    QImage page = FramePool::globalInstance()->allocate(pageSize, QImage::Format_ARGB32_Premultiplied);
+    if (page.isNull())
+        return QImage();
+    QColor background = geometry.whiteBackground ? Qt::white : Qt::transparent;
+
+    for (int start = 0; start < extent; start += thickness) {
+        int bandThickness = qMin(thickness, extent - start);
+        QRect band = columns ? QRect(start, 0, bandThickness, pageSize.height())
+                             : QRect(0, start, pageSize.width(), bandThickness);
+        QRect destination = geometry.imageRect.intersected(band);
+        QRect sourceRect;
+        QImage bandImage;
+
+        // 3 more pixels for the interpolation at the band borders
+        if (!destination.isEmpty())
+            sourceRect = toSource.mapRect(QRectF(destination)).toAlignedRect()
+                    .adjusted(-3, -3, 3, 3).intersected(sourceBounds);
+
+        if (sourceRect.isEmpty()) {
+            bandImage = FramePool::globalInstance()->allocate(band.size(), QImage::Format_ARGB32_Premultiplied);
+            if (bandImage.isNull())
+                return QImage();
+            bandImage.fill(background);
+        } else {
+            // A QImageReader reads its image only once.
+            QImageReader reader(fileName);
+            reader.setClipRect(sourceRect);
+            QImage part = reader.read();
+            if (part.isNull())
+                return QImage();
+            QTransform partToBand = QTransform::fromTranslate(sourceRect.x(), sourceRect.y())
+                    * geometry.transform
+                    * QTransform::fromTranslate(-band.x(), -band.y());
+            bandImage = ImageWarp::warp(part, partToBand, band.size(),
+                                        destination.translated(-band.topLeft()), background,
+                                        geometry.bicubic ? ImageWarp::BicubicInterpolation
+                                                         : ImageWarp::BilinearInterpolation);
+        }
+
+        bandImage = colorCorrect(bandImage, parameters.colorCorrection);
+        if (bandImage.format() != page.format())
+            bandImage = bandImage.convertToFormat(page.format());
+
+        for (int y = 0; y < band.height(); y++)
+            memcpy(page.scanLine(band.y() + y) + band.x() * 4, bandImage.constScanLine(y), band.width() * 4);
+    }
+
+    return page;
+}
+
+/** \brief true if the page is the source image turned by a multiple of 90° and cropped,
+  without any other change: no dekeystoning, scaling or layout border.
+
+  Such a page can be computed exactly by copying pixels (see renderExact()). turn gets the
+  quarter turn and turnedRect the part of the turned source image that makes the page.
+*/
+bool FilterEngine::exactGeometry(const PageGeometry &geometry, QSize sourceSize,
+                                 QTransform *turn, QRect *turnedRect)
+{
+    // Below a millionth of a pixel per pixel, rounding errors of the filters are ignored.
+    const qreal epsilon = 1e-6;
+    QTransform transform = geometry.transform;
+    qreal m[4] = { transform.m11(), transform.m12(), transform.m21(), transform.m22() };
+    QRect pageRect = QRect(QPoint(0, 0), geometry.pageSize);
+    int i;
+
+    if (!geometry.valid || geometry.imageRect != pageRect || transform.type() == QTransform::TxProject)
+        return false;
+
+    for (i = 0; i < 4; i++) {
+        if (qAbs(m[i] - qRound(m[i])) > epsilon)
+            return false;
+        m[i] = qRound(m[i]);
+    }
+    // A quarter turn: one coefficient of each row is +-1, and no mirror (determinant 1).
+    if (qAbs(m[0]) + qAbs(m[1]) != 1 || qAbs(m[2]) + qAbs(m[3]) != 1 || m[0] * m[3] - m[1] * m[2] != 1)
+        return false;
+
+    QTransform rotation = QTransform(m[0], m[1], m[2], m[3], 0, 0);
+    // QImage::transformed() moves the turned image to the origin.
+    QTransform turnedToOrigin = QImage::trueMatrix(rotation, sourceSize.width(), sourceSize.height());
+    QPointF offset = QPointF(transform.dx() - turnedToOrigin.dx(), transform.dy() - turnedToOrigin.dy());
+    if (qAbs(offset.x() - qRound(offset.x())) > 1e-3 || qAbs(offset.y() - qRound(offset.y())) > 1e-3)
+        return false;
+
+    QRect rect = QRect(QPoint(-qRound(offset.x()), -qRound(offset.y())), geometry.pageSize);
+    if (!QRect(QPoint(0, 0), rotation.mapRect(QRect(QPoint(0, 0), sourceSize)).size()).contains(rect))
+        return false;
+
+    if (turn)
+        *turn = rotation;
+    if (turnedRect)
+        *turnedRect = rect;
+    return true;
+}
+
+/** \brief Computes a page with an exact geometry (see exactGeometry()) by copying pixels.
+
+  @returns a null image if the geometry is not exact.
+*/
+QImage FilterEngine::renderExact(const QImage &source, const PageGeometry &geometry)
+{
+    QTransform turn;
+    QRect rect;
+
+    if (!exactGeometry(geometry, source.size(), &turn, &rect))
+        return QImage();
+
+    // QImage::transformed() copies the pixels of quarter turns without interpolation.
+    QImage turned = turn.isIdentity() ? source : source.transformed(turn);
+    if (rect == turned.rect())
+        return turned;
+    return turned.copy(rect);
+}
+
+/** \brief true if the page is exactly the image in fileName: the file can be used as it is.
+
+  Images with an orientation tag are not unchanged, as the tag would turn the copy of the file.
+*/
+bool FilterEngine::isUnchanged(QString fileName, const PageParameters &parameters)
+{
+    QImageReader reader(fileName);
+    QSize size = reader.size();
+
+    if (!size.isValid() || reader.transformation() != QImageIOHandler::TransformationNone
+            || !parameters.colorCorrection.isIdentity())
+        return false;
+
+    QTransform turn;
+    QRect rect;
+    return exactGeometry(pageGeometry(size, parameters), size, &turn, &rect)
+            && turn.isIdentity() && rect == QRect(QPoint(0, 0), size);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FILTERENGINE_H
+#define FILTERENGINE_H
+
+#include <QImage>
+#include <QTransform>
+#include "filterparameters.h"
+#include "constants.h"
+
+/* Where the pixels of a source image land on the resulting page.
+
+  transform maps source image coordinates to page coordinates; it is the product
+  of the transformations of all geometric filters (Rotation, Dekeystoning, Cropping,
+  Scale and Layout). imageRect is the part of the page covered by the image (with
+  Dekeystoning, only the selected quadrilateral); the rest of the page is background.
+*/
+struct PageGeometry
+{
+    bool valid = false;
+    QTransform transform;
+    QSize pageSize;
+    QRect imageRect;
+    // true when the page background is white (Layout), false for transparent
+    bool whiteBackground = false;
+    // true to interpolate bicubically instead of bilinearly (Best scale quality)
+    bool bicubic = false;
+};
+
+/* The image processing of all filters, without any widget.
+
+  Every function is reentrant: it only works on its arguments, so pages can be computed
+  concurrently on worker threads, or in a process without GUI (QCoreApplication).
+  The filters (Rotation, Dekeystoning...) call these functions with the parameters
+  of their widgets.
+*/
+class FilterEngine
+{
+public:
+    /* StagedRendering computes each filter one after the other, as the FilterContainer does.
+       FusedRendering combines all geometric filters into one transformation and resamples
+       each pixel once: this is faster and less blurry.
+       StreamedRendering is FusedRendering computed band by band, reading only the needed
+       part of the source file for each band (see renderStreamed()). */
+    enum RenderMode { StagedRendering, FusedRendering, StreamedRendering };
+
+    static QImage rotate(const QImage &inputImage, const RotationParameters &parameters);
+    static QImage dekeystone(const QImage &inputImage, const DekeystoningParameters &parameters);
+    static QImage crop(const QImage &inputImage, const CroppingParameters &parameters);
+    static QImage scale(const QImage &inputImage, const ScaleParameters &parameters);
+    static QImage layout(const QImage &inputImage, const LayoutParameters &parameters);
+    static QImage colorCorrect(const QImage &inputImage, const ColorCorrectionParameters &parameters);
+    static QImage renderStage(QString identifier, const QImage &inputImage,
+                              const QMap<QString, QVariant> &settings, qreal proxyScale = 1.0);
+
+    // Proxy images used for the interactive preview (see FilterContainer).
+    static qreal proxyScale(QSize imageSize, QSizeF viewSize);
+    static QImage proxyImage(const QImage &image, qreal scale);
+
+    // Applies the whole filter chain, in the same order as the FilterContainer.
+    static QImage render(const QImage &source, const PageParameters &parameters,
+                         RenderMode mode = StagedRendering);
+    static QImage render(QString fileName, const QMap<QString, QVariant> &settings,
+                         RenderMode mode = StagedRendering);
+    static QImage render(QString fileName, const PageParameters &parameters,
+                         RenderMode mode = StagedRendering);
+
+    static PageGeometry pageGeometry(QSize sourceSize, const PageParameters &parameters);
+    static QImage renderFused(const QImage &source, const PageParameters &parameters);
+    static QImage renderStreamed(QString fileName, const PageParameters &parameters,
+                                 int bandSize = Constants::STREAMED_BAND_SIZE);
+    static bool isLargeImage(QString fileName);
+
+    // Pages that are only the source image turned by quarter turns and cropped.
+    static bool exactGeometry(const PageGeometry &geometry, QSize sourceSize,
+                              QTransform *turn = 0, QRect *turnedRect = 0);
+    static QImage renderExact(const QImage &source, const PageGeometry &geometry);
+    static bool isUnchanged(QString fileName, const PageParameters &parameters);
+
+private:
+    static bool resamplesScale(const PageParameters &parameters);
+    static PageParameters withoutScale(const PageParameters &parameters);
+    static QSize transformedSize(const QTransform &matrix, QSize size);
+    static QPoint layoutOffset(QSize imageSize, QSizeF pageSize, const LayoutParameters &parameters);
+};
+
+#endif // FILTERENGINE_H
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filterparameters.h"
+
+#include <QLineF>
+
+// Default corner positions, the same as in the graphics views of the filters.
+static const QPointF defaultTopLeft = QPointF(100, 100);
+static const QPointF defaultTopRight = QPointF(500, 100);
+static const QPointF defaultBottomRight = QPointF(500, 500);
+static const QPointF defaultBottomLeft = QPointF(100, 500);
+
+// Helper: returns settings[key] as a point, or defaultPoint if not available.
+static QPointF pointSetting(const QMap<QString, QVariant> &settings, QString key, QPointF defaultPoint)
+{
+    if (settings.contains(key) && settings[key].canConvert(QVariant::PointF))
+        return settings[key].toPointF();
+    return defaultPoint;
+}
+
+// Helper: the "enabled" setting, which defaults to true on all filters.
+static bool enabledSetting(const QMap<QString, QVariant> &settings)
+{
+    if (settings.contains("enabled"))
+        return settings["enabled"].toBool();
+    return true;
+}
+
+RotationParameters RotationParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    RotationParameters parameters;
+
+    parameters.enabled = enabledSetting(settings);
+    parameters.angle = settings.value("rotation", 0).toInt();
+
+    return parameters;
+}
+
+/** \brief Mean width of the polygon, used as the width of the resulting image.
+*/
+qreal DekeystoningParameters::meanWidth() const
+{
+    if (polygon.size() != 4)
+        return 0;
+
+    QLineF line1 = QLineF(polygon[0], polygon[1]);
+    QLineF line2 = QLineF(polygon[2], polygon[3]);
+
+    return (line1.length() + line2.length()) / 2;
+}
+
+/** \brief Mean height of the polygon, used as the height of the resulting image.
+*/
+qreal DekeystoningParameters::meanHeight() const
+{
+    if (polygon.size() != 4)
+        return 0;
+
+    QLineF line1 = QLineF(polygon[1], polygon[2]);
+    QLineF line2 = QLineF(polygon[0], polygon[3]);
+
+    return (line1.length() + line2.length()) / 2;
+}
+
+DekeystoningParameters DekeystoningParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    DekeystoningParameters parameters;
+
+    parameters.enabled = enabledSetting(settings);
+    parameters.polygon << pointSetting(settings, "topLeftCorner", defaultTopLeft)
+                       << pointSetting(settings, "topRightCorner", defaultTopRight)
+                       << pointSetting(settings, "bottomRightCorner", defaultBottomRight)
+                       << pointSetting(settings, "bottomLeftCorner", defaultBottomLeft);
+
+    return parameters;
+}
+
+DekeystoningParameters DekeystoningParameters::scaled(qreal factor) const
+{
+    DekeystoningParameters parameters = *this;
+
+    for (int i = 0; i < parameters.polygon.size(); i++)
+        parameters.polygon[i] *= factor;
+
+    return parameters;
+}
+
+CroppingParameters CroppingParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    CroppingParameters parameters;
+
+    parameters.enabled = enabledSetting(settings);
+    parameters.rectangle = QRect(pointSetting(settings, "topLeftCorner", defaultTopLeft).toPoint(),
+                                 pointSetting(settings, "bottomRightCorner", defaultBottomRight).toPoint());
+
+    return parameters;
+}
+
+CroppingParameters CroppingParameters::scaled(qreal factor) const
+{
+    CroppingParameters parameters = *this;
+
+    parameters.rectangle = QRect(QPoint(qRound(rectangle.left() * factor), qRound(rectangle.top() * factor)),
+                                 QSize(qRound(rectangle.width() * factor), qRound(rectangle.height() * factor)));
+
+    return parameters;
+}
+
+ScaleParameters ScaleParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    ScaleParameters parameters;
+
+    parameters.enabled = enabledSetting(settings);
+    parameters.pxImageWidth = settings.value("pxImageWidth", 0).toDouble();
+    parameters.pxImageHeight = settings.value("pxImageHeight", 0).toDouble();
+    if (settings.contains("quality"))
+        parameters.quality = settings["quality"].toString();
+
+    return parameters;
+}
+
+ScaleParameters ScaleParameters::scaled(qreal factor) const
+{
+    ScaleParameters parameters = *this;
+
+    parameters.pxImageWidth = pxImageWidth * factor;
+    parameters.pxImageHeight = pxImageHeight * factor;
+
+    return parameters;
+}
+
+LayoutParameters LayoutParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    LayoutParameters parameters;
+
+    parameters.enabled = enabledSetting(settings);
+    parameters.pxPageWidth = settings.value("pxPageWidth", 0).toDouble();
+    parameters.pxPageHeight = settings.value("pxPageHeight", 0).toDouble();
+    if (settings.contains("horizontalAlignement"))
+        parameters.horizontalAlignement = settings["horizontalAlignement"].toString();
+    if (settings.contains("verticalAlignement"))
+        parameters.verticalAlignement = settings["verticalAlignement"].toString();
+
+    return parameters;
+}
+
+LayoutParameters LayoutParameters::scaled(qreal factor) const
+{
+    LayoutParameters parameters = *this;
+
+    parameters.pxPageWidth = pxPageWidth * factor;
+    parameters.pxPageHeight = pxPageHeight * factor;
+
+    return parameters;
+}
+
+ColorCorrectionParameters ColorCorrectionParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    ColorCorrectionParameters parameters;
+
+    parameters.enabled = enabledSetting(settings);
+    if (settings.contains("whitepoint"))
+        parameters.whitePoint.setNamedColor(settings["whitepoint"].toString());
+    if (settings.contains("blackpoint"))
+        parameters.blackPoint.setNamedColor(settings["blackpoint"].toString());
+
+    return parameters;
+}
+
+/** \brief true if the color correction does not change any pixel. */
+bool ColorCorrectionParameters::isIdentity() const
+{
+    return !enabled || (whitePoint.rgb() == qRgb(255, 255, 255) && blackPoint.rgb() == qRgb(0, 0, 0));
+}
+
+/** \brief Builds the parameters of all filters from the page settings.
+
+  The keys are the filter identifiers (BaseFilter::getIdentifier()); missing filters get
+  their default settings, as in FilterContainer::setSettings().
+*/
+PageParameters PageParameters::fromSettings(const QMap<QString, QVariant> &settings)
+{
+    PageParameters parameters;
+
+    parameters.rotation = RotationParameters::fromSettings(settings["Rotation"].toMap());
+    parameters.dekeystoning = DekeystoningParameters::fromSettings(settings["Dekeystoning"].toMap());
+    parameters.cropping = CroppingParameters::fromSettings(settings["Cropping"].toMap());
+    parameters.scale = ScaleParameters::fromSettings(settings["ScaleFilter"].toMap());
+    parameters.layout = LayoutParameters::fromSettings(settings["LayoutFilter"].toMap());
+    parameters.colorCorrection = ColorCorrectionParameters::fromSettings(settings["colorcorrection"].toMap());
+
+    return parameters;
+}
+
+/** \brief Returns the parameters for the scanned image resized by factor.
+*/
+PageParameters PageParameters::scaled(qreal factor) const
+{
+    PageParameters parameters = *this;
+
+    parameters.dekeystoning = dekeystoning.scaled(factor);
+    parameters.cropping = cropping.scaled(factor);
+    parameters.scale = scale.scaled(factor);
+    parameters.layout = layout.scaled(factor);
+
+    return parameters;
+}
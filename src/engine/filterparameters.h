@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FILTERPARAMETERS_H
+#define FILTERPARAMETERS_H
+
+#include <QMap>
+#include <QVariant>
+#include <QString>
+#include <QPolygonF>
+#include <QRect>
+#include <QColor>
+
+/* Plain parameter structs for every filter.
+
+  They carry the same information as the filter widgets, but have no dependency on
+  QWidget or QGraphicsScene: they can be copied to worker threads or used in a process
+  without GUI. Each struct is built from the settings QMap a filter returns with
+  getSettings() (and which ImageTableWidget stores for each page), so that the
+  GUI and the FilterEngine always interpret the settings the same way.
+*/
+
+struct RotationParameters
+{
+    bool enabled = true;
+    int angle = 0;              // in degrees
+
+    static RotationParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+struct DekeystoningParameters
+{
+    bool enabled = true;
+    // topLeft, topRight, bottomRight, bottomLeft corners
+    QPolygonF polygon;
+
+    qreal meanWidth() const;
+    qreal meanHeight() const;
+    DekeystoningParameters scaled(qreal factor) const;
+    static DekeystoningParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+struct CroppingParameters
+{
+    bool enabled = true;
+    QRect rectangle;
+
+    CroppingParameters scaled(qreal factor) const;
+    static CroppingParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+struct ScaleParameters
+{
+    bool enabled = true;
+    // 0 x 0 means "not set yet": the ScaleWidget then uses the input image size.
+    qreal pxImageWidth = 0;
+    qreal pxImageHeight = 0;
+    // One of Constants::scaleQuality: Fast is nearest neighbour, Smooth bicubic, Best Lanczos3
+    // (Best also interpolates the fused geometry bicubically, see PageGeometry)
+    QString quality = "Smooth";
+
+    ScaleParameters scaled(qreal factor) const;
+    static ScaleParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+struct LayoutParameters
+{
+    bool enabled = true;
+    // 0 x 0 means "not set yet": the LayoutWidget then uses the input image size.
+    qreal pxPageWidth = 0;
+    qreal pxPageHeight = 0;
+    QString horizontalAlignement = "Center";
+    QString verticalAlignement = "Center";
+
+    LayoutParameters scaled(qreal factor) const;
+    static LayoutParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+struct ColorCorrectionParameters
+{
+    bool enabled = true;
+    QColor whitePoint = Qt::white;
+    QColor blackPoint = Qt::black;
+
+    bool isIdentity() const;
+    static ColorCorrectionParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+/* All the parameters needed to compute one page.
+
+  fromSettings() takes the settings as returned by FilterContainer::getSettings(): a QMap
+  from the filter identifier to the filter settings.
+
+  All pixel values are given in the resolution of the scanned image. scaled() returns the
+  parameters for a copy of the scanned image resized by factor (a proxy used for the
+  interactive preview); rotation and color correction do not depend on the resolution.
+*/
+struct PageParameters
+{
+    RotationParameters rotation;
+    DekeystoningParameters dekeystoning;
+    CroppingParameters cropping;
+    ScaleParameters scale;
+    LayoutParameters layout;
+    ColorCorrectionParameters colorCorrection;
+
+    PageParameters scaled(qreal factor) const;
+    static PageParameters fromSettings(const QMap<QString, QVariant> &settings);
+};
+
+#endif // FILTERPARAMETERS_H
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framepool.h"
+
+#include <QMutexLocker>
+#include <QThreadStorage>
+#include <QDebug>
+#include <cstdlib>
+
+// Name of the stage computed by each thread (see FramePool::Stage)
+static QThreadStorage<QString> currentStage;
+
+/* What an image allocated by the pool needs to give its buffer back. */
+struct FramePool::Buffer
+{
+    FramePool *pool;
+    uchar *data;
+    qint64 size;
+    QString stage;
+};
+
+FramePool::Stage::Stage(QString name)
+{
+    previousName = currentStage.localData();
+    currentStage.setLocalData(name);
+}
+
+FramePool::Stage::~Stage()
+{
+    currentStage.setLocalData(previousName);
+}
+
+FramePool::FramePool()
+{
+    maxFreeBytes = (qint64) defaultMaxSize() * 1024 * 1024;
+}
+
+FramePool *FramePool::globalInstance()
+{
+    // Never destroyed: images may still give their buffers back while the program exits.
+    static FramePool *instance = new FramePool();
+    return instance;
+}
+
+/** \brief Returns an image of the given size and format, with an undefined content.
+
+  @returns a null image if the memory can not be allocated.
+*/
+QImage FramePool::allocate(QSize size, QImage::Format format)
+{
+    if (size.isEmpty() || format == QImage::Format_Invalid)
+        return QImage();
+
+    int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    // QImage scan lines are aligned on 32 bits
+    int bytesPerLine = ((size.width() * depth + 31) / 32) * 4;
+    qint64 bytes = (qint64) bytesPerLine * size.height();
+    QString stage = currentStage.hasLocalData() && !currentStage.localData().isEmpty()
+            ? currentStage.localData() : QString("Other");
+    uchar *data = 0;
+
+    mutex.lock();
+    QMultiHash<qint64, uchar *>::iterator found = freeBuffers.find(bytes);
+    if (found != freeBuffers.end()) {
+        data = found.value();
+        freeBuffers.erase(found);
+        freeBytes -= bytes;
+        stages[stage].reused++;
+    }
+    mutex.unlock();
+
+    if (!data)
+        data = (uchar *) malloc(bytes);
+    if (!data)
+        return QImage();
+
+    Buffer *buffer = new Buffer;
+    buffer->pool = this;
+    buffer->data = data;
+    buffer->size = bytes;
+    buffer->stage = stage;
+
+    mutex.lock();
+    FrameStatistics &statistics = stages[stage];
+    statistics.allocations++;
+    statistics.liveBytes += bytes;
+    statistics.peakBytes = qMax(statistics.peakBytes, statistics.liveBytes);
+    totalLiveBytes += bytes;
+    totalPeakBytes = qMax(totalPeakBytes, totalLiveBytes);
+    mutex.unlock();
+
+    return QImage(data, size.width(), size.height(), bytesPerLine, format,
+                  &FramePool::releaseBuffer, buffer);
+}
+
+// Called by QImage when the last copy of an image of the pool is destroyed.
+void FramePool::releaseBuffer(void *info)
+{
+    Buffer *buffer = static_cast<Buffer *>(info);
+    buffer->pool->release(buffer);
+}
+
+void FramePool::release(Buffer *buffer)
+{
+    bool keep;
+
+    mutex.lock();
+    stages[buffer->stage].liveBytes -= buffer->size;
+    totalLiveBytes -= buffer->size;
+    keep = freeBytes + buffer->size <= maxFreeBytes;
+    if (keep) {
+        freeBuffers.insert(buffer->size, buffer->data);
+        freeBytes += buffer->size;
+    }
+    mutex.unlock();
+
+    if (!keep)
+        free(buffer->data);
+    delete buffer;
+}
+
+/** \brief Sets the maximal size of the unused buffers kept for next images, in MB. */
+void FramePool::setMaxSize(int megabytes)
+{
+    QList<uchar *> buffers;
+
+    mutex.lock();
+    maxFreeBytes = (qint64) megabytes * 1024 * 1024;
+    // Give the buffers exceeding the new size back to the system.
+    QMultiHash<qint64, uchar *>::iterator buffer = freeBuffers.begin();
+    while (freeBytes > maxFreeBytes && buffer != freeBuffers.end()) {
+        freeBytes -= buffer.key();
+        buffers.append(buffer.value());
+        buffer = freeBuffers.erase(buffer);
+    }
+    mutex.unlock();
+
+    foreach (uchar *data, buffers)
+        free(data);
+}
+
+int FramePool::maxSize()
+{
+    QMutexLocker locker(&mutex);
+    return maxFreeBytes / (1024 * 1024);
+}
+
+/** \brief About the size of the images of a few stages of a photographed page. */
+int FramePool::defaultMaxSize()
+{
+    return 256;
+}
+
+/** \brief Returns the memory statistics of each stage. */
+QMap<QString, FrameStatistics> FramePool::statistics()
+{
+    QMutexLocker locker(&mutex);
+    return stages;
+}
+
+qint64 FramePool::liveBytes()
+{
+    QMutexLocker locker(&mutex);
+    return totalLiveBytes;
+}
+
+qint64 FramePool::peakBytes()
+{
+    QMutexLocker locker(&mutex);
+    return totalPeakBytes;
+}
+
+qint64 FramePool::pooledBytes()
+{
+    QMutexLocker locker(&mutex);
+    return freeBytes;
+}
+
+/** \brief Writes the statistics of each stage to the debug output.
+
+  Called once when the application exits; while it runs, the MemoryStatisticsDialog
+  shows the same numbers.
+*/
+void FramePool::logStatistics()
+{
+    QMap<QString, FrameStatistics> stageStatistics = statistics();
+
+    qDebug() << "FramePool: live" << liveBytes() / 1024 << "KB, peak" << peakBytes() / 1024
+             << "KB, pooled" << pooledBytes() / 1024 << "KB";
+    foreach (QString stage, stageStatistics.keys()) {
+        const FrameStatistics &statistics = stageStatistics[stage];
+        qDebug() << "FramePool:" << stage << "live" << statistics.liveBytes / 1024
+                 << "KB, peak" << statistics.peakBytes / 1024 << "KB," << statistics.allocations
+                 << "allocations," << statistics.reused << "reused";
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QImage>
+#include <QMap>
+#include <QMultiHash>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+/* Memory used by the images of one stage (see FramePool::Stage). */
+struct FrameStatistics
+{
+    // bytes of the pooled images alive now, and the most that was alive at once
+    qint64 liveBytes = 0;
+    qint64 peakBytes = 0;
+    int allocations = 0;
+    // allocations served by a buffer of the pool instead of a new one
+    int reused = 0;
+};
+
+/* A pool of image buffers, shared by all stages and threads.
+
+  allocate() returns a QImage whose buffer goes back to the pool when the last copy of the
+  image is destroyed. The next image of the same size (usually the same stage of the next
+  page) gets this buffer again, instead of giving hundreds of MB back to the system and
+  asking for them again at each page. At most maxSize() MB of unused buffers are kept.
+
+  The pool counts the bytes of its images for each stage: declare a Stage in the function
+  computing a stage, all images allocated in this thread until the Stage is destroyed are
+  counted for it. Images not allocated by the pool (for example by QImage::transformed())
+  are not counted.
+*/
+class FramePool
+{
+public:
+    /* Names the stage of the images allocated by the current thread. */
+    class Stage
+    {
+    public:
+        Stage(QString name);
+        ~Stage();
+    private:
+        QString previousName;
+    };
+
+    static FramePool *globalInstance();
+
+    QImage allocate(QSize size, QImage::Format format);
+
+    void setMaxSize(int megabytes);
+    int maxSize();
+    static int defaultMaxSize();
+
+    QMap<QString, FrameStatistics> statistics();
+    qint64 liveBytes();
+    qint64 peakBytes();
+    qint64 pooledBytes();
+    void logStatistics();
+
+private:
+    struct Buffer;
+    FramePool();
+    static void releaseBuffer(void *info);
+    void release(Buffer *buffer);
+
+    QMutex mutex;
+    // unused buffers by size in bytes
+    QMultiHash<qint64, uchar *> freeBuffers;
+    qint64 freeBytes = 0;
+    qint64 maxFreeBytes;
+    QMap<QString, FrameStatistics> stages;
+    qint64 totalLiveBytes = 0;
+    qint64 totalPeakBytes = 0;
+};
+
+#endif // FRAMEPOOL_H
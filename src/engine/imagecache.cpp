@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imagecache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+ImageCache::ImageCache()
+{
+    setMaxSize(defaultMaxSize());
+}
+
+/** \brief The cache shared by all pages of the running application */
+ImageCache *ImageCache::globalInstance()
+{
+    static ImageCache instance;
+    return &instance;
+}
+
+/** \brief Identifies the content of an image file.
+
+  The file is identified by its path, size and modification time, so that a scan
+  replaced on disk is not taken from the cache.
+*/
+QByteArray ImageCache::sourceKey(QString fileName)
+{
+    QFileInfo info(fileName);
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    stream << info.absoluteFilePath() << info.size() << info.lastModified();
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/** \brief Identifies the output of a stage.
+
+  @param inputKey the key of the image given to the stage. If it is empty, the input
+  cannot be identified and the returned key is empty too (it is never found in the cache).
+  @param stage the stage identifier (for filters, BaseFilter::getIdentifier())
+  @param settings every setting the output depends on
+*/
+QByteArray ImageCache::stageKey(const QByteArray &inputKey, QString stage,
+                                const QMap<QString, QVariant> &settings)
+{
+    if (inputKey.isEmpty())
+        return QByteArray();
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+
+    // QMap is sorted by key, so the same settings always give the same stream.
+    stream << inputKey << stage << settings;
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/** \brief Looks for key in the cache.
+
+  @returns true and sets image if the key was found. Images are implicitly shared,
+  so no pixel is copied.
+*/
+bool ImageCache::find(const QByteArray &key, QImage *image)
+{
+    if (key.isEmpty())
+        return false;
+
+    QMutexLocker locker(&mutex);
+    QImage *cached = cache.object(key);
+    if (!cached)
+        return false;
+
+    *image = *cached;
+    return true;
+}
+
+/** \brief Stores image under key.
+
+  Null images and images bigger than the whole budget are not stored.
+*/
+void ImageCache::insert(const QByteArray &key, const QImage &image)
+{
+    if (key.isEmpty() || image.isNull())
+        return;
+
+    QMutexLocker locker(&mutex);
+    cache.insert(key, new QImage(image), qMax(1, image.byteCount() / 1024));
+}
+
+void ImageCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    cache.clear();
+}
+
+/** \brief Sets the memory budget of the cache. 0 disables the cache. */
+void ImageCache::setMaxSize(int megabytes)
+{
+    QMutexLocker locker(&mutex);
+    cache.setMaxCost(qMax(0, megabytes) * 1024);
+}
+
+int ImageCache::maxSize()
+{
+    QMutexLocker locker(&mutex);
+    return cache.maxCost() / 1024;
+}
+
+/** \brief Enough for the proxies and stage outputs of a few dozen pages. */
+int ImageCache::defaultMaxSize()
+{
+    return 512;
+}
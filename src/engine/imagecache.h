@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QCache>
+#include <QByteArray>
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+
+/* A cache of images shared by all pages, limited by a memory budget.
+
+  Entries are keyed by a hash describing how the image was computed: sourceKey()
+  identifies a scanned image file, and stageKey() derives the key of the output of a
+  stage from the key of its input and the stage settings. Two pages with the same
+  source and the same settings up to a stage therefore share the entry, and changing
+  the settings of a stage automatically invalidates it and all following stages.
+
+  The least recently used images are dropped when the budget is exceeded. The cache
+  can be used from several threads.
+*/
+class ImageCache
+{
+public:
+    static ImageCache *globalInstance();
+
+    static QByteArray sourceKey(QString fileName);
+    static QByteArray stageKey(const QByteArray &inputKey, QString stage,
+                               const QMap<QString, QVariant> &settings);
+
+    bool find(const QByteArray &key, QImage *image);
+    void insert(const QByteArray &key, const QImage &image);
+    void clear();
+
+    void setMaxSize(int megabytes);
+    int maxSize();
+    static int defaultMaxSize();
+
+private:
+    ImageCache();
+    // cost of the entries in kilobytes
+    QCache<QByteArray, QImage> cache;
+    QMutex mutex;
+};
+
+#endif // IMAGECACHE_H
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imagewarp.h"
+#include "framepool.h"
+
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/qmath.h>
+
+// (x * a + y * b) / 256 for all 4 channels at once; a + b must be 256.
+static inline uint interpolate256(uint x, uint a, uint y, uint b)
+{
+    uint t = (x & 0xff00ff) * a + (y & 0xff00ff) * b;
+    t >>= 8;
+    t &= 0xff00ff;
+
+    x = ((x >> 8) & 0xff00ff) * a + ((y >> 8) & 0xff00ff) * b;
+    x &= 0xff00ff00;
+    return x | t;
+}
+
+// x * a / 255 for all 4 channels at once
+static inline uint byteMul(uint x, uint a)
+{
+    uint t = (x & 0xff00ff) * a;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+
+    x = ((x >> 8) & 0xff00ff) * a;
+    x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+    x &= 0xff00ff00;
+    return x | t;
+}
+
+// Source pixel, transparent outside of the image.
+static inline uint pixelAt(const uchar *bits, int bytesPerLine, int width, int height, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        return 0;
+    return reinterpret_cast<const uint *>(bits + y * bytesPerLine)[x];
+}
+
+// Bilinear interpolation at (fx, fy), in source pixel coordinates (pixel centers at integer values).
+static inline uint sampleBilinear(const uchar *bits, int bytesPerLine, int width, int height,
+                                  qreal fx, qreal fy)
+{
+    int x0 = qFloor(fx);
+    int y0 = qFloor(fy);
+
+    if (x0 < -1 || y0 < -1 || x0 >= width || y0 >= height)
+        return 0;
+
+    uint wx = uint((fx - x0) * 256);
+    uint wy = uint((fy - y0) * 256);
+
+    uint topLeft = pixelAt(bits, bytesPerLine, width, height, x0, y0);
+    uint topRight = pixelAt(bits, bytesPerLine, width, height, x0 + 1, y0);
+    uint bottomLeft = pixelAt(bits, bytesPerLine, width, height, x0, y0 + 1);
+    uint bottomRight = pixelAt(bits, bytesPerLine, width, height, x0 + 1, y0 + 1);
+
+    uint top = interpolate256(topLeft, 256 - wx, topRight, wx);
+    uint bottom = interpolate256(bottomLeft, 256 - wx, bottomRight, wx);
+    return interpolate256(top, 256 - wy, bottom, wy);
+}
+
+// Catmull-Rom weights of the 4 pixels around t (0 <= t < 1), in 1/256 units; they add up to 256.
+static inline void cubicWeights(qreal t, int *weights)
+{
+    qreal t2 = t * t;
+    qreal t3 = t2 * t;
+
+    weights[0] = qRound((-0.5 * t3 + t2 - 0.5 * t) * 256);
+    weights[1] = qRound((1.5 * t3 - 2.5 * t2 + 1) * 256);
+    weights[2] = qRound((-1.5 * t3 + 2 * t2 + 0.5 * t) * 256);
+    weights[3] = 256 - weights[0] - weights[1] - weights[2];
+}
+
+// Bicubic interpolation at (fx, fy), in source pixel coordinates (pixel centers at integer values).
+static inline uint sampleBicubic(const uchar *bits, int bytesPerLine, int width, int height,
+                                 qreal fx, qreal fy)
+{
+    int x0 = qFloor(fx);
+    int y0 = qFloor(fy);
+
+    if (x0 < -2 || y0 < -2 || x0 > width || y0 > height)
+        return 0;
+
+    int wx[4], wy[4];
+    cubicWeights(fx - x0, wx);
+    cubicWeights(fy - y0, wy);
+
+    // 1/65536 units; the rounding is added first
+    int sums[4] = { 1 << 15, 1 << 15, 1 << 15, 1 << 15 };
+    int i, j, channel;
+    for (j = 0; j < 4; j++) {
+        int row[4] = { 0, 0, 0, 0 };
+        for (i = 0; i < 4; i++) {
+            uint pixel = pixelAt(bits, bytesPerLine, width, height, x0 - 1 + i, y0 - 1 + j);
+            for (channel = 0; channel < 4; channel++)
+                row[channel] += int((pixel >> (8 * channel)) & 0xff) * wx[i];
+        }
+        for (channel = 0; channel < 4; channel++)
+            sums[channel] += row[channel] * wy[j];
+    }
+
+    uint value[4];
+    for (channel = 0; channel < 4; channel++)
+        value[channel] = uint(qBound(0, sums[channel] >> 16, 255));
+    // The negative lobes may give a color larger than alpha.
+    return (value[3] << 24)
+            | (qMin(value[2], value[3]) << 16)
+            | (qMin(value[1], value[3]) << 8)
+            | qMin(value[0], value[3]);
+}
+
+/** \brief Computes the destination rows firstRow .. lastRow - 1 of job.
+
+  The homogeneous source coordinates (sx, sy, sw) of the first pixel center of a row
+  are mapped once; each pixel to the right adds (m11, m12, m13).
+*/
+void ImageWarp::warpRows(const Job *job, int firstRow, int lastRow)
+{
+    const QTransform &matrix = job->destinationToSource;
+    bool projective = matrix.type() == QTransform::TxProject;
+    const uchar *bits = job->source->constBits();
+    int bytesPerLine = job->source->bytesPerLine();
+    int width = job->source->width();
+    int height = job->source->height();
+    int left = job->destinationRect.left();
+    int right = job->destinationRect.right();
+    uint backgroundPixel = job->backgroundPixel;
+    bool bicubic = job->interpolation == BicubicInterpolation;
+
+    int x, y;
+    uint pixel;
+    qreal fx, fy;
+    for (y = firstRow; y < lastRow; y++) {
+        uint *line = reinterpret_cast<uint *>(job->destinationBits + y * job->destinationBytesPerLine);
+        // map the pixel center; source pixel centers are at +0.5
+        qreal sx = matrix.m11() * (left + 0.5) + matrix.m21() * (y + 0.5) + matrix.m31();
+        qreal sy = matrix.m12() * (left + 0.5) + matrix.m22() * (y + 0.5) + matrix.m32();
+        qreal sw = matrix.m13() * (left + 0.5) + matrix.m23() * (y + 0.5) + matrix.m33();
+        for (x = left; x <= right; x++) {
+            fx = sx;
+            fy = sy;
+            if (projective) {
+                // behind the horizon: not a point of the source image
+                fx = sw > 0 ? sx / sw : -4;
+                fy = sw > 0 ? sy / sw : -4;
+            }
+            if (bicubic)
+                pixel = sampleBicubic(bits, bytesPerLine, width, height, fx - 0.5, fy - 0.5);
+            else
+                pixel = sampleBilinear(bits, bytesPerLine, width, height, fx - 0.5, fy - 0.5);
+            // draw the sample over the background
+            line[x] = pixel + byteMul(backgroundPixel, 255 - qAlpha(pixel));
+
+            sx += matrix.m11();
+            sy += matrix.m12();
+            sw += matrix.m13();
+        }
+    }
+}
+
+/** \brief Computes the destination image.
+
+  sourceToDestination maps source coordinates to destination coordinates (as for QImage::transformed,
+  but without moving the result to the origin). It must be invertible, else a null image is returned.
+*/
+QImage ImageWarp::warp(const QImage &source, const QTransform &sourceToDestination,
+                       QSize destinationSize, QRect destinationRect, QColor background,
+                       Interpolation interpolation)
+{
+    bool invertible = false;
+    QTransform destinationToSource = sourceToDestination.inverted(&invertible);
+
+    if (!invertible || source.isNull() || destinationSize.isEmpty())
+        return QImage();
+
+    // RGB32 has the same memory layout as ARGB32_Premultiplied (with opaque alpha)
+    QImage input = source;
+    if (input.format() != QImage::Format_RGB32
+            && input.format() != QImage::Format_ARGB32_Premultiplied) {
+        input = input.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    uint backgroundPixel = qPremultiply(background.rgba());
+    QImage destination = FramePool::globalInstance()->allocate(destinationSize,
+                                                               QImage::Format_ARGB32_Premultiplied);
+    if (destination.isNull())
+        return destination;
+    destination.fill(backgroundPixel);
+
+    destinationRect &= destination.rect();
+    if (destinationRect.isEmpty())
+        return destination;
+
+    Job job;
+    job.source = &input;
+    job.destinationBits = destination.bits();
+    job.destinationBytesPerLine = destination.bytesPerLine();
+    job.destinationToSource = destinationToSource;
+    job.destinationRect = destinationRect;
+    job.backgroundPixel = backgroundPixel;
+    job.interpolation = interpolation;
+
+    int top = destinationRect.top();
+    int rows = destinationRect.height();
+    int bands = qMin(rows, qMax(1, QThread::idealThreadCount()));
+    QList<QFuture<void> > running;
+    int band;
+    for (band = 1; band < bands; band++) {
+        running.append(QtConcurrent::run(warpRows, &job, top + rows * band / bands,
+                                         top + rows * (band + 1) / bands));
+    }
+    // The first band is computed in this thread
+    warpRows(&job, top, top + rows / bands);
+    foreach (QFuture<void> future, running)
+        future.waitForFinished();
+
+    return destination;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef IMAGEWARP_H
+#define IMAGEWARP_H
+
+#include <QImage>
+#include <QTransform>
+#include <QColor>
+
+/* Resamples an image through a projective transformation.
+
+  Each destination pixel is computed once, by mapping its center back into the source
+  image and interpolating the 4 (bilinear) or 16 (bicubic) neighbour source pixels.
+  Only destinationRect is computed; all other pixels, and the destination pixels that map
+  outside the source image, get the background color.
+
+  Along a row the homogeneous source coordinates change by a constant step, so they are
+  updated with 3 additions per pixel (and one division for perspective transformations)
+  instead of a full mapping. The rows are processed by all processor cores.
+
+  The result is always in Format_ARGB32_Premultiplied.
+*/
+class ImageWarp
+{
+public:
+    enum Interpolation { BilinearInterpolation, BicubicInterpolation };
+
+    static QImage warp(const QImage &source, const QTransform &sourceToDestination,
+                       QSize destinationSize, QRect destinationRect,
+                       QColor background = Qt::transparent,
+                       Interpolation interpolation = BilinearInterpolation);
+
+private:
+    // Everything the bands of one warp share; the bands only write through destinationBits.
+    struct Job
+    {
+        const QImage *source;
+        uchar *destinationBits;
+        int destinationBytesPerLine;
+        QTransform destinationToSource;
+        QRect destinationRect;
+        uint backgroundPixel;
+        Interpolation interpolation;
+    };
+
+    static void warpRows(const Job *job, int firstRow, int lastRow);
+};
+
+#endif // IMAGEWARP_H
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pageexporter.h"
+#include "constants.h"
+#include "framepool.h"
+#include "stagelog.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFuture>
+#include <QThread>
+#include <QFile>
+#include <QImageReader>
+
+PageExporter::PageExporter(QObject *parent) : QObject(parent)
+{
+    maxPages = defaultConcurrentPages();
+}
+
+/** \brief Sets the maximal number of pages computed at the same time.
+
+  Each page in progress holds some full size images in memory, so this has to be
+  reduced for very big images on computers with little memory.
+*/
+void PageExporter::setMaxConcurrentPages(int pages)
+{
+    maxPages = qMax(1, pages);
+}
+
+int PageExporter::maxConcurrentPages()
+{
+    return maxPages;
+}
+
+/** \brief One page per processor core */
+int PageExporter::defaultConcurrentPages()
+{
+    return qMax(1, QThread::idealThreadCount());
+}
+
+/** \brief Sets how the pages are compressed in PDF files (JPEG by default). */
+void PageExporter::setPdfCompression(PdfWriter::Compression compression)
+{
+    pdfCompression = compression;
+}
+
+void PageExporter::setRenderMode(FilterEngine::RenderMode mode)
+{
+    renderMode = mode;
+}
+
+void PageExporter::cancel()
+{
+    canceled = true;
+}
+
+/** \brief Computes each page and saves it in folder under its exportName.
+
+  @returns false if the export was canceled or if a page could not be saved.
+*/
+bool PageExporter::exportToFolder(QList<ExportPage> pages, QString folder)
+{
+    QList<QFuture<bool> > running;
+    int next = 0;
+    int done = 0;
+    bool allSaved = true;
+
+    canceled = false;
+
+    while (done < pages.size()) {
+        // Fill the pipeline up to maxPages pages
+        while (running.size() < maxPages && next < pages.size()) {
+            QString fileName = QString("%1/%2").arg(folder, pages[next].exportName);
+            running.append(QtConcurrent::run(&PageExporter::renderToFile, pages[next], fileName, renderMode));
+            next++;
+        }
+
+        if (!running.takeFirst().result()) {
+            qDebug() << "PageExporter: could not export" << pages[done].fileName;
+            allSaved = false;
+        }
+        done++;
+        emit progress(done);
+
+        if (canceled) {
+            // Pages in progress can not be interrupted; wait for them before returning.
+            foreach (QFuture<bool> future, running)
+                future.waitForFinished();
+            return false;
+        }
+    }
+    return allSaved;
+}
+
+/** \brief Computes all pages and writes them, in order, into pdfFile.
+
+  The size of each PDF page is calculated from the image size and DPI.
+  @returns false if the export was canceled or if a page could not be rendered (the PDF then
+  misses that page).
+*/
+bool PageExporter::exportToPdf(QList<ExportPage> pages, QString pdfFile, int DPI)
+{
+    QList<QFuture<PdfImage> > running;
+    int next = 0;
+    int done = 0;
+    bool allSaved = true;
+    PdfImage image;
+    PdfWriter writer(pdfFile);
+
+    if (!writer.open()) {
+        qDebug() << "PageExporter: can not write" << pdfFile << writer.errorString();
+        return false;
+    }
+
+    canceled = false;
+
+    while (done < pages.size()) {
+        // Fill the pipeline up to maxPages pages. Only the first page is written,
+        // the others wait in memory: this is why their number is limited.
+        while (running.size() < maxPages && next < pages.size()) {
+            running.append(QtConcurrent::run(&PageExporter::renderPdfPage, pages[next], renderMode,
+                                             pdfCompression));
+            next++;
+        }
+
+        image = running.takeFirst().result();
+        if (image.isNull()) {
+            qDebug() << "PageExporter: no image for" << pages[done].fileName;
+            allSaved = false;
+        } else if (!writer.addPage(image, DPI)) {
+            qDebug() << "PageExporter: can not write" << pdfFile << writer.errorString();
+            canceled = true;
+        }
+        done++;
+        emit progress(done);
+
+        if (canceled) {
+            foreach (QFuture<PdfImage> future, running)
+                future.waitForFinished();
+            writer.close();
+            return false;
+        }
+    }
+
+    return writer.close() && allSaved;
+}
+
+/** \brief Name of the exported file of a page, as used by exportToFolder()
+
+  row starts at 0.
+*/
+QString PageExporter::exportName(int row, bool leftSide)
+{
+    return QString("image_%1_%2.jpg")
+            .arg(row + 1, 3, 10, QChar('0'))
+            .arg(leftSide ? "Left" : "Right");
+}
+
+/** \brief Orders pages as in a book: left and right page of each row.
+*/
+QList<ExportPage> PageExporter::interleave(QList<ExportPage> leftPages, QList<ExportPage> rightPages)
+{
+    QList<ExportPage> pages;
+    int row;
+
+    for (row = 0; row < qMax(leftPages.size(), rightPages.size()); row++) {
+        if (row < leftPages.size())
+            pages.append(leftPages[row]);
+        if (row < rightPages.size())
+            pages.append(rightPages[row]);
+    }
+    return pages;
+}
+
+// true if the page is its source JPEG file without any change
+bool PageExporter::isUnchangedJpeg(ExportPage page)
+{
+    return QImageReader::imageFormat(page.fileName) == "jpeg"
+            && FilterEngine::isUnchanged(page.fileName, PageParameters::fromSettings(page.settings));
+}
+
+// Runs in a worker thread
+bool PageExporter::renderToFile(ExportPage page, QString fileName, FilterEngine::RenderMode mode)
+{
+    bool written = false;
+
+    StageLog::globalInstance()->startPage(logPage(page));
+    // An unchanged JPEG image is copied: this is much faster and has no generation loss.
+    if (isUnchangedJpeg(page)) {
+        StageTimer timer("Copy", logPage(page));
+        QFile::remove(fileName);
+        written = QFile::copy(page.fileName, fileName);
+    }
+
+    if (!written) {
+        QImage image = renderPage(page, mode);
+        StageTimer timer("Encode", logPage(page));
+        written = image.save(fileName, 0, Constants::EXPORT_JPEG_QUALITY);
+    }
+
+    StageLog::globalInstance()->finishPage(logPage(page));
+    return written;
+}
+
+// Runs in a worker thread: the page is compressed there too.
+PdfImage PageExporter::renderPdfPage(ExportPage page, FilterEngine::RenderMode mode,
+                                     PdfWriter::Compression compression)
+{
+    PdfImage image;
+
+    StageLog::globalInstance()->startPage(logPage(page));
+    // An unchanged JPEG image is embedded as it is, without generation loss.
+    if (compression == PdfWriter::JpegCompression && isUnchangedJpeg(page)) {
+        StageTimer timer("Copy", logPage(page));
+        image = PdfWriter::fromJpegFile(page.fileName);
+    }
+
+    if (image.isNull()) {
+        QImage pageImage = renderPage(page, mode);
+        StageTimer timer("Encode", logPage(page));
+        image = PdfWriter::encode(pageImage, compression, Constants::EXPORT_JPEG_QUALITY);
+    }
+
+    StageLog::globalInstance()->finishPage(logPage(page));
+    return image;
+}
+
+// Runs in a worker thread
+QImage PageExporter::renderPage(ExportPage page, FilterEngine::RenderMode mode)
+{
+    FramePool::Stage stage("Export");
+    // Decode and all filters: the export does not compute them one by one (see FilterEngine::render()).
+    StageTimer timer("Render", logPage(page));
+    return FilterEngine::render(page.fileName, page.settings, mode);
+}
+
+// Page of the StageLog: not the same as the page displayed by the GUI
+QString PageExporter::logPage(ExportPage page)
+{
+    return "Export " + page.fileName;
+}
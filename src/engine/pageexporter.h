@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PAGEEXPORTER_H
+#define PAGEEXPORTER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVariant>
+#include <QImage>
+#include "filterengine.h"
+#include "pdfwriter.h"
+
+/* One page to export: its source image and its filter settings
+   (as stored by ImageTableWidget, see FilterContainer::getSettings()). */
+struct ExportPage
+{
+    QString fileName;
+    QMap<QString, QVariant> settings;
+    // name of the exported file (only used by exportToFolder)
+    QString exportName;
+};
+
+/* Exports pages to a folder or to a PDF file, computing several pages at once.
+
+  Pages are computed with the FilterEngine on the global QThreadPool. At most
+  maxConcurrentPages() pages are computed or waiting to be written at the same time,
+  which limits the memory used by big books. Very large scans are computed band by band
+  (see FilterEngine::renderStreamed()). PDF pages are written in the order
+  of the list.
+
+  PageExporter does not use any widget and works in a QCoreApplication (PDF files are
+  written with PdfWriter, which needs no printer support). The progress() signal is emitted in the
+  calling thread after each written page, and cancel() may be called from a slot
+  connected to it (for example through a QProgressDialog).
+*/
+class PageExporter : public QObject
+{
+    Q_OBJECT
+public:
+    PageExporter(QObject *parent = 0);
+    void setMaxConcurrentPages(int pages);
+    int maxConcurrentPages();
+    static int defaultConcurrentPages();
+    void setRenderMode(FilterEngine::RenderMode mode);
+    void setPdfCompression(PdfWriter::Compression compression);
+
+    bool exportToFolder(QList<ExportPage> pages, QString folder);
+    bool exportToPdf(QList<ExportPage> pages, QString pdfFile, int DPI);
+
+    static QString exportName(int row, bool leftSide);
+    static QList<ExportPage> interleave(QList<ExportPage> leftPages, QList<ExportPage> rightPages);
+
+public slots:
+    void cancel();
+
+signals:
+    // number of pages exported up to now
+    void progress(int pages);
+
+private:
+    static bool isUnchangedJpeg(ExportPage page);
+    static QString logPage(ExportPage page);
+    static bool renderToFile(ExportPage page, QString fileName, FilterEngine::RenderMode mode);
+    static QImage renderPage(ExportPage page, FilterEngine::RenderMode mode);
+    static PdfImage renderPdfPage(ExportPage page, FilterEngine::RenderMode mode,
+                                  PdfWriter::Compression compression);
+
+    int maxPages;
+    // Export needs full quality: resample each page only once.
+    FilterEngine::RenderMode renderMode = FilterEngine::FusedRendering;
+    PdfWriter::Compression pdfCompression = PdfWriter::JpegCompression;
+    bool canceled = false;
+};
+
+#endif // PAGEEXPORTER_H
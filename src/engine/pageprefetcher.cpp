@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pageprefetcher.h"
+#include "filterengine.h"
+#include "imagecache.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QImageReader>
+
+PagePrefetcher::PagePrefetcher()
+{
+    // One page after the other, the nearest first, leaving the other cores to the displayed page.
+    pool.setMaxThreadCount(1);
+}
+
+PagePrefetcher::~PagePrefetcher()
+{
+    cancel();
+}
+
+/** \brief Replaces the pages waiting to be prefetched by pages.
+
+  pages should be ordered by probability of being displayed next. stages are the
+  identifiers of the filters to compute, in the order of the FilterContainer.
+  viewSize is the size of the view in device pixels, which defines the proxy size.
+*/
+void PagePrefetcher::prefetch(QList<PrefetchPage> pages, QStringList stages, QSizeF viewSize)
+{
+    PrefetchPage page;
+
+    // The pages asked for before are not interesting any more
+    pool.clear();
+    foreach (page, pages) {
+        QtConcurrent::run(&pool, PagePrefetcher::prefetchPage, page, stages, viewSize);
+    }
+}
+
+/** \brief Forgets the waiting pages and waits for the page in progress */
+void PagePrefetcher::cancel()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+/** \brief Computes the proxy and the stages of one page into the ImageCache.
+
+  The keys must be the same as in FilterContainer::setFilterImage() and BaseFilter::outputKey().
+*/
+void PagePrefetcher::prefetchPage(PrefetchPage page, QStringList stages, QSizeF viewSize)
+{
+    ImageCache *cache = ImageCache::globalInstance();
+    QMap<QString, QVariant> proxySettings;
+    QImage image;
+    QString stage;
+
+    if (page.fileName.isEmpty())
+        return;
+
+    qreal scale = FilterEngine::proxyScale(QImageReader(page.fileName).size(), viewSize);
+    proxySettings["scale"] = scale;
+    QByteArray key = ImageCache::stageKey(ImageCache::sourceKey(page.fileName), "Proxy", proxySettings);
+
+    if (!cache->find(key, &image)) {
+        image = FilterEngine::proxyImage(QImage(page.fileName), scale);
+        if (image.isNull())
+            return;
+        if (scale < 1)
+            cache->insert(key, image);
+    }
+
+    foreach (stage, stages) {
+        QMap<QString, QVariant> settings = page.settings[stage].toMap();
+        if (settings.isEmpty())
+            return;
+
+        QMap<QString, QVariant> keySettings = settings;
+        keySettings["proxyScale"] = scale;
+        key = ImageCache::stageKey(key, stage, keySettings);
+
+        QImage output;
+        if (!cache->find(key, &output)) {
+            output = FilterEngine::renderStage(stage, image, settings, scale);
+            cache->insert(key, output);
+        }
+        image = output;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PAGEPREFETCHER_H
+#define PAGEPREFETCHER_H
+
+#include <QList>
+#include <QMap>
+#include <QSizeF>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVariant>
+
+/* A page which will probably be displayed soon, with its stored settings */
+struct PrefetchPage
+{
+    QString fileName;
+    QMap<QString, QVariant> settings;
+};
+
+/* Prepares pages in the background before the user selects them.
+
+  For each page, the proxy image is decoded and the filters given by stages are
+  computed, exactly as the FilterContainer would do it, and stored in the ImageCache
+  with the same keys. When the user selects the page, FilterContainer finds everything
+  in the cache.
+
+  A filter is only computed if the page has settings for it: without them, the
+  widget uses defaults which are only known when the page is displayed.
+*/
+class PagePrefetcher
+{
+public:
+    PagePrefetcher();
+    ~PagePrefetcher();
+
+    void prefetch(QList<PrefetchPage> pages, QStringList stages, QSizeF viewSize);
+    void cancel();
+
+    static void prefetchPage(PrefetchPage page, QStringList stages, QSizeF viewSize);
+
+private:
+    QThreadPool pool;
+};
+
+#endif // PAGEPREFETCHER_H
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pdfwriter.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QImageWriter>
+#include <QPainter>
+
+// Objects written by close(), their numbers are reserved by open().
+static const int CATALOG_OBJECT = 1;
+static const int PAGES_OBJECT = 2;
+
+PdfWriter::PdfWriter(QString fileName) : file(fileName)
+{
+}
+
+PdfWriter::~PdfWriter()
+{
+    if (file.isOpen())
+        close();
+}
+
+/** \brief Creates the file and writes the PDF header. */
+bool PdfWriter::open()
+{
+    failed = !file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (failed)
+        return false;
+
+    offsets.clear();
+    pageObjects.clear();
+    newObject();    // CATALOG_OBJECT
+    newObject();    // PAGES_OBJECT
+
+    // The binary comment tells file transfer programs that the file is binary.
+    write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+    return !failed;
+}
+
+/** \brief Writes a page showing the image, of the size of the image at DPI. */
+bool PdfWriter::addPage(const PdfImage &image, int DPI)
+{
+    if (!file.isOpen() || image.isNull() || DPI <= 0)
+        return false;
+
+    int imageObject = newObject();
+    int contentObject = newObject();
+    int pageObject = newObject();
+    // 72 points per inch
+    QByteArray width = QByteArray::number((qreal) image.size.width() * 72 / DPI, 'f', 3);
+    QByteArray height = QByteArray::number((qreal) image.size.height() * 72 / DPI, 'f', 3);
+
+    writeStreamObject(imageObject,
+                      "/Type /XObject /Subtype /Image"
+                      " /Width " + QByteArray::number(image.size.width()) +
+                      " /Height " + QByteArray::number(image.size.height()) +
+                      " /ColorSpace " + (image.components == 1 ? "/DeviceGray" : "/DeviceRGB") +
+                      " /BitsPerComponent 8"
+                      " /Filter /" + image.filter,
+                      image.data);
+
+    writeStreamObject(contentObject, QByteArray(),
+                      "q " + width + " 0 0 " + height + " 0 0 cm /Im0 Do Q\n");
+
+    beginObject(pageObject);
+    write("<< /Type /Page /Parent " + QByteArray::number(PAGES_OBJECT) + " 0 R"
+          " /MediaBox [0 0 " + width + " " + height + "]"
+          " /Resources << /XObject << /Im0 " + QByteArray::number(imageObject) + " 0 R >> >>"
+          " /Contents " + QByteArray::number(contentObject) + " 0 R >>\nendobj\n");
+
+    pageObjects.append(pageObject);
+    return !failed;
+}
+
+/** \brief Writes the page tree, the cross-reference table and closes the file. */
+bool PdfWriter::close()
+{
+    if (!file.isOpen())
+        return false;
+
+    QByteArray kids;
+    foreach (int page, pageObjects)
+        kids += QByteArray::number(page) + " 0 R ";
+
+    beginObject(PAGES_OBJECT);
+    write("<< /Type /Pages /Kids [ " + kids + "] /Count " + QByteArray::number(pageObjects.size())
+          + " >>\nendobj\n");
+
+    beginObject(CATALOG_OBJECT);
+    write("<< /Type /Catalog /Pages " + QByteArray::number(PAGES_OBJECT) + " 0 R >>\nendobj\n");
+
+    // Each entry of the table must be exactly 20 bytes long.
+    qint64 xref = file.pos();
+    write("xref\n0 " + QByteArray::number(offsets.size() + 1) + "\n0000000000 65535 f \n");
+    foreach (qint64 offset, offsets)
+        write(QByteArray::number(offset).rightJustified(10, '0') + " 00000 n \n");
+
+    write("trailer\n<< /Size " + QByteArray::number(offsets.size() + 1)
+          + " /Root " + QByteArray::number(CATALOG_OBJECT) + " 0 R >>\n"
+          "startxref\n" + QByteArray::number(xref) + "\n%%EOF\n");
+
+    file.close();
+    return !failed && file.error() == QFileDevice::NoError;
+}
+
+QString PdfWriter::errorString()
+{
+    return file.errorString();
+}
+
+/** \brief Compresses an image for addPage().
+
+  PDF images have no alpha channel: transparent parts become white, like paper.
+  Gray images (Mono, gray Indexed8, Grayscale8...) are stored with one component, all
+  other images as RGB.
+  JpegCompression is lossy with the given quality (0-100), FlateCompression is lossless.
+  @returns a null PdfImage if the image is null or can not be compressed.
+*/
+PdfImage PdfWriter::encode(const QImage &image, Compression compression, int quality)
+{
+    PdfImage result;
+    QImage opaque = image;
+
+    if (image.isNull())
+        return result;
+
+    if (image.hasAlphaChannel()) {
+        opaque = QImage(image.size(), QImage::Format_RGB32);
+        opaque.fill(Qt::white);
+        QPainter painter(&opaque);
+        painter.drawImage(0, 0, image);
+        painter.end();
+    } else if (image.isGrayscale()) {
+        opaque = image.convertToFormat(QImage::Format_Grayscale8);
+        result.components = 1;
+    } else {
+        // The JPEG writer keeps the number of components of the image (one for Indexed8).
+        opaque = image.convertToFormat(QImage::Format_RGB32);
+    }
+
+    if (compression == JpegCompression) {
+        QBuffer buffer(&result.data);
+        buffer.open(QIODevice::WriteOnly);
+        QImageWriter writer(&buffer, "jpeg");
+        writer.setQuality(quality);
+        if (!writer.write(opaque))
+            return PdfImage();
+        result.filter = "DCTDecode";
+    } else {
+        // PDF samples are packed: QImage scan lines are padded to 4 bytes.
+        if (result.components == 3)
+            opaque = opaque.convertToFormat(QImage::Format_RGB888);
+        int rowLength = opaque.width() * result.components;
+        QByteArray pixels;
+        pixels.reserve(rowLength * opaque.height());
+        for (int y = 0; y < opaque.height(); y++)
+            pixels.append((const char *) opaque.constScanLine(y), rowLength);
+        // qCompress() writes the uncompressed size (4 bytes) before the zlib stream.
+        result.data = qCompress(pixels).mid(4);
+        result.filter = "FlateDecode";
+    }
+
+    result.size = image.size();
+    return result;
+}
+
+/** \brief Reads a JPEG file to embed it as it is.
+
+  The size and the number of color components are read from the frame header (SOF marker).
+  @returns a null PdfImage if the file can not be read, is not a baseline or progressive
+  JPEG, or is not gray or RGB (CMYK JPEG files need an inverted decode array).
+*/
+PdfImage PdfWriter::fromJpegFile(QString fileName)
+{
+    PdfImage result;
+    QFile jpegFile(fileName);
+
+    if (!jpegFile.open(QIODevice::ReadOnly))
+        return result;
+    QByteArray data = jpegFile.readAll();
+    const uchar *bytes = (const uchar *) data.constData();
+    int position = 2;
+
+    if (data.size() < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8)
+        return result;
+
+    // Walk through the marker segments up to the frame header.
+    while (position + 4 <= data.size()) {
+        if (bytes[position] != 0xFF)
+            return result;
+        uchar marker = bytes[position + 1];
+        int length = (bytes[position + 2] << 8) | bytes[position + 3];
+        if (marker == 0xFF) {
+            // fill byte
+            position++;
+            continue;
+        }
+        // SOF0 (baseline), SOF1 (extended) and SOF2 (progressive), all Huffman coded
+        if (marker == 0xC0 || marker == 0xC1 || marker == 0xC2) {
+            if (position + 10 > data.size() || bytes[position + 4] != 8)
+                return result;
+            int height = (bytes[position + 5] << 8) | bytes[position + 6];
+            int width = (bytes[position + 7] << 8) | bytes[position + 8];
+            int components = bytes[position + 9];
+            if (width == 0 || height == 0 || (components != 1 && components != 3))
+                return result;
+            result.size = QSize(width, height);
+            result.components = components;
+            result.filter = "DCTDecode";
+            result.data = data;
+            return result;
+        }
+        // start of scan before any supported frame header
+        if (marker == 0xDA)
+            return result;
+        position += 2 + length;
+    }
+
+    return result;
+}
+
+// Reserves the number of a new object, written later with beginObject().
+int PdfWriter::newObject()
+{
+    offsets.append(0);
+    return offsets.size();
+}
+
+void PdfWriter::beginObject(int number)
+{
+    offsets[number - 1] = file.pos();
+    write(QByteArray::number(number) + " 0 obj\n");
+}
+
+void PdfWriter::writeStreamObject(int number, const QByteArray &dictionary, const QByteArray &data)
+{
+    beginObject(number);
+    write("<< " + dictionary + " /Length " + QByteArray::number(data.size()) + " >>\nstream\n");
+    write(data);
+    write("\nendstream\nendobj\n");
+}
+
+void PdfWriter::write(const QByteArray &data)
+{
+    if (file.write(data) != data.size())
+        failed = true;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PDFWRITER_H
+#define PDFWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+/* One page image, already compressed in the format PDF stores it. */
+struct PdfImage
+{
+    QByteArray data;
+    QSize size;
+    // 1 for gray images, 3 for RGB
+    int components = 3;
+    // PDF filter to decode data: "DCTDecode" (JPEG) or "FlateDecode" (zlib)
+    QByteArray filter;
+
+    bool isNull() const { return data.isEmpty(); }
+};
+
+/* Writes a PDF file made of one image per page.
+
+  The images are embedded as they are compressed by encode(): JPEG data is copied as a
+  DCTDecode stream and is not decoded again. fromJpegFile() embeds a JPEG file as it is,
+  without any generation loss. Each page is written to the file as soon
+  as it is added, so only the object offsets are kept in memory, whatever the number
+  of pages. The page size (MediaBox) is the image size at the given DPI.
+
+  PdfWriter is not thread safe, but encode() is reentrant and may be called in worker
+  threads.
+*/
+class PdfWriter
+{
+public:
+    enum Compression { JpegCompression, FlateCompression };
+
+    PdfWriter(QString fileName);
+    ~PdfWriter();
+
+    bool open();
+    bool addPage(const PdfImage &image, int DPI);
+    bool close();
+    QString errorString();
+
+    static PdfImage encode(const QImage &image, Compression compression, int quality = 90);
+    static PdfImage fromJpegFile(QString fileName);
+
+private:
+    int newObject();
+    void beginObject(int number);
+    void writeStreamObject(int number, const QByteArray &dictionary, const QByteArray &data);
+    void write(const QByteArray &data);
+
+    QFile file;
+    // file position of each object, at index (object number - 1)
+    QVector<qint64> offsets;
+    QList<int> pageObjects;
+    bool failed = false;
+};
+
+#endif // PDFWRITER_H
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "projectreader.h"
+#include "constants.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QPointF>
+#include <QXmlStreamReader>
+
+/** \brief Loads the pages and global settings of the project fileName.
+
+  The file is read in one pass with a QXmlStreamReader: no DOM tree is built, so that projects
+  with thousands of pages open quickly.
+  @returns false if the file can not be read or is not a valid project; errorString() then
+  describes the problem.
+*/
+bool ProjectReader::load(QString fileName)
+{
+    pages[0].clear();
+    pages[1].clear();
+    defaults.clear();
+    sides[0].clear();
+    sides[1].clear();
+    dpi = Constants::DEFAULT_DPI;
+
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        error = QString("Could not open \"%1\"").arg(fileName);
+        return false;
+    }
+
+    QXmlStreamReader xml(&file);
+    if (!xml.readNextStartElement() || xml.name() != QLatin1String("yasw")) {
+        if (xml.hasError())
+            error = parseError(xml, fileName);
+        else
+            error = QString("\"%1\" is not a valid YASW project file").arg(fileName);
+        return false;
+    }
+
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("global")) {
+            dpi = intAttribute(xml.attributes(), "DPI", Constants::DEFAULT_DPI);
+            xml.skipCurrentElement();
+        } else if (xml.name() == QLatin1String("defaults")) {
+            if (!readDefaults(xml, fileName))
+                return false;
+        } else if (xml.name() == QLatin1String("image")) {
+            if (!readImage(xml, fileName))
+                return false;
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+
+    if (xml.hasError()) {
+        error = parseError(xml, fileName);
+        return false;
+    }
+    return true;
+}
+
+/** \brief Reads the <image> element at the current position of xml into pages */
+bool ProjectReader::readImage(QXmlStreamReader &xml, QString fileName)
+{
+    QXmlStreamAttributes attributes = xml.attributes();
+    QStringRef side = attributes.value("side");
+    int sideIndex;
+
+    if (side == QLatin1String("left")) {
+        sideIndex = 0;
+    } else if (side == QLatin1String("right")) {
+        sideIndex = 1;
+    } else {
+        error = QString("Unknown side \"%1\" in \"%2\"").arg(side.toString(), fileName);
+        return false;
+    }
+
+    ExportPage page;
+    page.fileName = attributes.value("filename").toString();
+    page.exportName = PageExporter::exportName(pages[sideIndex].size(), sideIndex == 0);
+    page.settings = readFilters(xml);
+
+    pages[sideIndex].append(page);
+    return true;
+}
+
+/** \brief Reads the <defaults> element at the current position of xml */
+bool ProjectReader::readDefaults(QXmlStreamReader &xml, QString fileName)
+{
+    QXmlStreamAttributes attributes = xml.attributes();
+
+    if (!attributes.hasAttribute("side")) {
+        defaults = readFilters(xml);
+        return true;
+    }
+
+    QStringRef side = attributes.value("side");
+    if (side == QLatin1String("left")) {
+        sides[0] = readFilters(xml);
+    } else if (side == QLatin1String("right")) {
+        sides[1] = readFilters(xml);
+    } else {
+        error = QString("Unknown side \"%1\" in \"%2\"").arg(side.toString(), fileName);
+        return false;
+    }
+    return true;
+}
+
+/** \brief The identifiers of the filters stored in a project, in the order of the filter tabs */
+QStringList ProjectReader::filterIdentifiers()
+{
+    return QStringList() << "Rotation" << "Dekeystoning" << "Cropping" << "ScaleFilter"
+                         << "LayoutFilter" << "colorcorrection";
+}
+
+/** \brief The attributes of the filter identifier stored under the name of their setting.
+
+  The values of the "px" attributes are numbers, the others strings. The Rotation angle and
+  the "enabled" attribute of every filter are handled apart.
+*/
+QStringList ProjectReader::filterAttributes(QString identifier)
+{
+    if (identifier == "ScaleFilter")
+        return QStringList() << "pxImageWidth" << "pxImageHeight" << "quality";
+    if (identifier == "LayoutFilter")
+        return QStringList() << "pxPageWidth" << "pxPageHeight" << "horizontalAlignement" << "verticalAlignement";
+    if (identifier == "colorcorrection")
+        return QStringList() << "whitepoint" << "blackpoint";
+    return QStringList();
+}
+
+/** \brief The corners of the filter identifier, stored as sub elements with x and y attributes */
+QStringList ProjectReader::cornerNames(QString identifier)
+{
+    if (identifier == "Dekeystoning")
+        return QStringList() << "topLeftCorner" << "topRightCorner" << "bottomRightCorner" << "bottomLeftCorner";
+    if (identifier == "Cropping")
+        return QStringList() << "bottomRightCorner" << "topLeftCorner";
+    return QStringList();
+}
+
+/** \brief Reads the filter elements inside the current element of xml */
+QMap<QString, QVariant> ProjectReader::readFilters(QXmlStreamReader &xml)
+{
+    QMap<QString, QVariant> filters;
+
+    while (xml.readNextStartElement()) {
+        QString identifier = xml.name().toString();
+        QMap<QString, QVariant> settings = filterSettings(xml);
+        // Unknown filters are ignored
+        if (!settings.isEmpty())
+            filters[identifier] = settings;
+    }
+    return filters;
+}
+
+/** \brief Reads the filter element at the current position of xml.
+
+  The reader is left after the end of the element. Returns empty settings for unknown filters.
+*/
+QMap<QString, QVariant> ProjectReader::filterSettings(QXmlStreamReader &xml)
+{
+    QMap<QString, QVariant> settings;
+    QXmlStreamAttributes attributes = xml.attributes();
+    QString identifier = xml.name().toString();
+    QStringList corners = cornerNames(identifier);
+    QString name;
+
+    if (!filterIdentifiers().contains(identifier)) {
+        xml.skipCurrentElement();
+        return settings;
+    }
+
+    if (identifier == "Rotation")
+        settings["rotation"] = intAttribute(attributes, "angle", 0);
+    if (identifier == "colorcorrection") {
+        settings["whitepoint"] = QString("#FFFFFF");
+        settings["blackpoint"] = QString("#000000");
+    }
+    foreach (name, filterAttributes(identifier)) {
+        if (!attributes.hasAttribute(name))
+            continue;
+        if (name.startsWith("px"))
+            settings[name] = attributes.value(name).toDouble();
+        else
+            settings[name] = attributes.value(name).toString();
+    }
+    settings["enabled"] = intAttribute(attributes, "enabled", 1);
+
+    while (xml.readNextStartElement()) {
+        name = xml.name().toString();
+        if (corners.contains(name)) {
+            QXmlStreamAttributes point = xml.attributes();
+            settings[name] = QPointF(point.value("x").toDouble(), point.value("y").toDouble());
+        }
+        xml.skipCurrentElement();
+    }
+    return settings;
+}
+
+int ProjectReader::intAttribute(const QXmlStreamAttributes &attributes, QString name, int defaultValue)
+{
+    if (!attributes.hasAttribute(name))
+        return defaultValue;
+    return attributes.value(name).toInt();
+}
+
+QString ProjectReader::parseError(const QXmlStreamReader &xml, QString fileName)
+{
+    return QString("A problem occured while parsing file \"%1\" : Line %2, Column %3: %4")
+            .arg(fileName, QString::number(xml.lineNumber()), QString::number(xml.columnNumber()),
+                 xml.errorString());
+}
+
+QString ProjectReader::errorString()
+{
+    return error;
+}
+
+int ProjectReader::DPI()
+{
+    return dpi;
+}
+
+QList<ExportPage> ProjectReader::leftPages()
+{
+    return mergedPages(0);
+}
+
+QList<ExportPage> ProjectReader::rightPages()
+{
+    return mergedPages(1);
+}
+
+/** \brief Settings of the filters that apply to all pages not overriding them */
+QMap<QString, QVariant> ProjectReader::projectDefaults()
+{
+    return defaults;
+}
+
+/** \brief Settings of the filters that apply to all pages of side (0: left, 1: right) */
+QMap<QString, QVariant> ProjectReader::sideDefaults(int side)
+{
+    return sides[side];
+}
+
+/** \brief Pages of side with only the settings stored in their own <image> element */
+QList<ExportPage> ProjectReader::storedPages(int side)
+{
+    return pages[side];
+}
+
+/** \brief Pages of side with the settings of all layers resolved */
+QList<ExportPage> ProjectReader::mergedPages(int side)
+{
+    QList<ExportPage> merged;
+    QMap<QString, QVariant> inherited = defaults;
+    QString identifier;
+
+    foreach (identifier, sides[side].keys())
+        inherited[identifier] = sides[side][identifier];
+
+    foreach (ExportPage page, pages[side]) {
+        QMap<QString, QVariant> settings = inherited;
+        foreach (identifier, page.settings.keys())
+            settings[identifier] = page.settings[identifier];
+        page.settings = settings;
+        merged.append(page);
+    }
+    return merged;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PROJECTREADER_H
+#define PROJECTREADER_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QXmlStreamReader>
+#include "pageexporter.h"
+
+/* Reads a .yasw project file without any widget.
+
+  The file is streamed (see load()); ProjectWriter writes the same schema.
+
+  The settings of a filter are given by the first of these layers that contains it:
+  the <image> element, then <defaults side="left|right">, then <defaults> of the whole
+  project. leftPages() and rightPages() return the resolved settings of each page.
+*/
+class ProjectReader
+{
+public:
+    bool load(QString fileName);
+    QString errorString();
+
+    int DPI();
+    QList<ExportPage> leftPages();
+    QList<ExportPage> rightPages();
+
+    QMap<QString, QVariant> projectDefaults();
+    QMap<QString, QVariant> sideDefaults(int side);
+    QList<ExportPage> storedPages(int side);
+
+    static QStringList filterIdentifiers();
+    static QStringList filterAttributes(QString identifier);
+    static QStringList cornerNames(QString identifier);
+
+private:
+    bool readImage(QXmlStreamReader &xml, QString fileName);
+    bool readDefaults(QXmlStreamReader &xml, QString fileName);
+    static QMap<QString, QVariant> readFilters(QXmlStreamReader &xml);
+    QList<ExportPage> mergedPages(int side);
+    static QMap<QString, QVariant> filterSettings(QXmlStreamReader &xml);
+    static int intAttribute(const QXmlStreamAttributes &attributes, QString name, int defaultValue);
+    static QString parseError(const QXmlStreamReader &xml, QString fileName);
+
+    QString error;
+    int dpi = 0;
+    // Settings as stored in the file: see storedPages()
+    QList<ExportPage> pages[2];
+    QMap<QString, QVariant> defaults;
+    QMap<QString, QVariant> sides[2];
+};
+
+#endif // PROJECTREADER_H
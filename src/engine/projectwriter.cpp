@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "projectwriter.h"
+#include "projectreader.h"
+#include "constants.h"
+
+#include <QFile>
+#include <QPoint>
+#include <QStringList>
+
+void ProjectWriter::setDPI(int DPI)
+{
+    dpi = DPI;
+}
+
+/** \brief Sets the filter settings used by all pages, or all pages of one side, that do not override them */
+void ProjectWriter::setDefaults(QMap<QString, QVariant> projectDefaults,
+                                QMap<QString, QVariant> leftDefaults,
+                                QMap<QString, QVariant> rightDefaults)
+{
+    defaults = projectDefaults;
+    sides[0] = leftDefaults;
+    sides[1] = rightDefaults;
+}
+
+/** \brief Sets the pages to save; only fileName and settings of each page are written */
+void ProjectWriter::setPages(QList<ExportPage> leftPages, QList<ExportPage> rightPages)
+{
+    pages[0] = leftPages;
+    pages[1] = rightPages;
+}
+
+/** \brief Saves the global settings and the pages of both sides to fileName.
+
+  @returns false if the file can not be written; errorString() then describes the problem.
+*/
+bool ProjectWriter::save(QString fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Text)) {
+        error = QString("Could not open \"%1\" for writing").arg(fileName);
+        return false;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(4);
+
+    xml.writeStartDocument();
+    xml.writeStartElement("yasw");
+    xml.writeAttribute("version", VERSION);
+
+    xml.writeStartElement("global");
+    xml.writeAttribute("DPI", QString::number(dpi));
+    xml.writeEndElement();
+
+    writeDefaults(xml, QString(), defaults);
+    writeDefaults(xml, "left", sides[0]);
+    writeDefaults(xml, "right", sides[1]);
+
+    foreach (const ExportPage &page, pages[0])
+        writeImage(xml, "left", page);
+    foreach (const ExportPage &page, pages[1])
+        writeImage(xml, "right", page);
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+
+    if (xml.hasError()) {
+        error = QString("A problem occured while writing file \"%1\"").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+QString ProjectWriter::errorString()
+{
+    return error;
+}
+
+void ProjectWriter::writeImage(QXmlStreamWriter &xml, QString side, const ExportPage &page)
+{
+    xml.writeStartElement("image");
+    xml.writeAttribute("side", side);
+    xml.writeAttribute("filename", page.fileName);
+    writeFilters(xml, page.settings);
+    xml.writeEndElement();
+}
+
+/** \brief Writes a <defaults> element; nothing is written if there are no settings */
+void ProjectWriter::writeDefaults(QXmlStreamWriter &xml, QString side,
+                                  const QMap<QString, QVariant> &settings)
+{
+    if (settings.isEmpty())
+        return;
+
+    xml.writeStartElement("defaults");
+    if (!side.isEmpty())
+        xml.writeAttribute("side", side);
+    writeFilters(xml, settings);
+    xml.writeEndElement();
+}
+
+void ProjectWriter::writeFilters(QXmlStreamWriter &xml, const QMap<QString, QVariant> &settings)
+{
+    QString identifier;
+
+    foreach (identifier, ProjectReader::filterIdentifiers()) {
+        if (settings.contains(identifier))
+            writeFilter(xml, identifier, settings[identifier].toMap());
+    }
+}
+
+/** \brief Writes the settings of one filter (see ProjectReader::filterAttributes()) */
+void ProjectWriter::writeFilter(QXmlStreamWriter &xml, QString identifier,
+                                const QMap<QString, QVariant> &settings)
+{
+    QString name;
+
+    xml.writeStartElement(identifier);
+
+    if (identifier == "Rotation")
+        xml.writeAttribute("angle", QString::number(settings.value("rotation", 0).toInt()));
+    foreach (name, ProjectReader::filterAttributes(identifier)) {
+        if (!settings.contains(name))
+            continue;
+        if (name.startsWith("px"))
+            xml.writeAttribute(name, Constants::float2String(settings[name].toDouble()));
+        else
+            xml.writeAttribute(name, settings[name].toString());
+    }
+    xml.writeAttribute("enabled", settings.value("enabled", true).toBool() ? "1" : "0");
+
+    // Attributes must be written before the sub elements
+    writeCorners(xml, ProjectReader::cornerNames(identifier), settings);
+
+    xml.writeEndElement();
+}
+
+void ProjectWriter::writeCorners(QXmlStreamWriter &xml, QStringList cornerNames,
+                                 const QMap<QString, QVariant> &settings)
+{
+    QString corner;
+    QPoint point;
+
+    foreach (corner, cornerNames) {
+        if (settings.contains(corner)) {
+            point = settings[corner].toPoint();
+            xml.writeStartElement(corner);
+            xml.writeAttribute("x", QString::number(point.x()));
+            xml.writeAttribute("y", QString::number(point.y()));
+            xml.writeEndElement();
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PROJECTWRITER_H
+#define PROJECTWRITER_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVariant>
+#include <QXmlStreamWriter>
+#include "pageexporter.h"
+
+/* Writes a .yasw project file without any widget (counterpart of ProjectReader).
+
+  The file is written in one pass with a QXmlStreamWriter; the attributes of each filter
+  are given by ProjectReader (see ProjectReader::filterAttributes()). The settings of the pages only hold the filters that differ
+  from the project and side defaults (see ProjectReader).
+*/
+class ProjectWriter
+{
+public:
+    void setDPI(int DPI);
+    void setDefaults(QMap<QString, QVariant> projectDefaults, QMap<QString, QVariant> leftDefaults,
+                     QMap<QString, QVariant> rightDefaults);
+    void setPages(QList<ExportPage> leftPages, QList<ExportPage> rightPages);
+    bool save(QString fileName);
+    QString errorString();
+
+private:
+    static void writeImage(QXmlStreamWriter &xml, QString side, const ExportPage &page);
+    static void writeDefaults(QXmlStreamWriter &xml, QString side, const QMap<QString, QVariant> &settings);
+    static void writeFilters(QXmlStreamWriter &xml, const QMap<QString, QVariant> &settings);
+    static void writeFilter(QXmlStreamWriter &xml, QString identifier,
+                            const QMap<QString, QVariant> &settings);
+    static void writeCorners(QXmlStreamWriter &xml, QStringList cornerNames,
+                             const QMap<QString, QVariant> &settings);
+
+    QString error;
+    int dpi = 0;
+    QList<ExportPage> pages[2];
+    QMap<QString, QVariant> defaults;
+    QMap<QString, QVariant> sides[2];
+};
+
+#endif // PROJECTWRITER_H
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resampler.h"
+#include "framepool.h"
+
+#include <QThread>
+#include <QFuture>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/qmath.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// The weights are fixed point numbers with this number of bits after the point. They fit in
+// a qint16, as no weight is much larger than 1.
+static const int PRECISION_BITS = 14;
+// Reductions by a larger factor use the area average (box filter)
+static const qreal AREA_REDUCTION = 4.0;
+
+static qreal boxFilter(qreal x)
+{
+    return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+// Keys cubic convolution with a = -0.5
+static qreal bicubicFilter(qreal x)
+{
+    const qreal a = -0.5;
+    x = qAbs(x);
+    if (x < 1.0)
+        return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    if (x < 2.0)
+        return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+    return 0.0;
+}
+
+static qreal sinc(qreal x)
+{
+    if (x == 0.0)
+        return 1.0;
+    x *= M_PI;
+    return qSin(x) / x;
+}
+
+static qreal lanczos3Filter(qreal x)
+{
+    if (x > -3.0 && x < 3.0)
+        return sinc(x) * sinc(x / 3.0);
+    return 0.0;
+}
+
+/* Sums of the weighted channels of one destination pixel.
+   With SSE2 the 4 channels are added at once, 2 source pixels per instruction. */
+#ifdef __SSE2__
+typedef __m128i Sums;
+
+static inline Sums initialSums()
+{
+    // Rounds the result to the nearest value
+    return _mm_set1_epi32(1 << (PRECISION_BITS - 1));
+}
+
+static inline Sums addPixels(Sums sums, uint pixel0, uint pixel1, qint16 weight0, qint16 weight1)
+{
+    // 16 bit channels, interleaved: blue0 blue1 green0 green1 ...
+    __m128i pixels = _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel0), _mm_cvtsi32_si128(pixel1));
+    pixels = _mm_unpacklo_epi8(pixels, _mm_setzero_si128());
+    __m128i weights = _mm_set1_epi32(int((uint(quint16(weight1)) << 16) | quint16(weight0)));
+    return _mm_add_epi32(sums, _mm_madd_epi16(pixels, weights));
+}
+
+static inline uint toPixel(Sums sums)
+{
+    sums = _mm_srai_epi32(sums, PRECISION_BITS);
+    // Saturates every channel to 0..255
+    sums = _mm_packs_epi32(sums, sums);
+    sums = _mm_packus_epi16(sums, sums);
+    return uint(_mm_cvtsi128_si32(sums));
+}
+#else
+struct Sums
+{
+    int channel[4];
+};
+
+static inline Sums initialSums()
+{
+    Sums sums;
+    sums.channel[0] = sums.channel[1] = sums.channel[2] = sums.channel[3] = 1 << (PRECISION_BITS - 1);
+    return sums;
+}
+
+static inline Sums addPixels(Sums sums, uint pixel0, uint pixel1, qint16 weight0, qint16 weight1)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+        sums.channel[i] += int((pixel0 >> (8 * i)) & 0xff) * weight0 + int((pixel1 >> (8 * i)) & 0xff) * weight1;
+    return sums;
+}
+
+static inline uint toPixel(Sums sums)
+{
+    uint pixel = 0;
+    int i;
+    for (i = 0; i < 4; i++)
+        pixel |= uint(qBound(0, sums.channel[i] >> PRECISION_BITS, 255)) << (8 * i);
+    return pixel;
+}
+#endif
+
+// The negative lobes of the filters may give a color larger than alpha.
+static inline uint premultiplied(uint pixel)
+{
+    uint alpha = pixel >> 24;
+    return (alpha << 24)
+            | (qMin((pixel >> 16) & 0xff, alpha) << 16)
+            | (qMin((pixel >> 8) & 0xff, alpha) << 8)
+            | qMin(pixel & 0xff, alpha);
+}
+
+/** \brief Returns image resized to size, in Format_RGB32 or Format_ARGB32_Premultiplied.
+
+  The filter is used for enlargements and small reductions (see AREA_REDUCTION).
+*/
+QImage Resampler::resize(const QImage &image, QSize size, Filter filter)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+
+    // RGB32 has the same memory layout as ARGB32_Premultiplied (with opaque alpha)
+    QImage input = image;
+    if (input.format() != QImage::Format_RGB32
+            && input.format() != QImage::Format_ARGB32_Premultiplied) {
+        input = input.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    if (size == input.size())
+        return input;
+
+    int bands = qMax(1, QThread::idealThreadCount());
+    QList<QFuture<void> > running;
+    Destination destination;
+    int band, rows;
+
+    // Horizontal pass: source height, destination width
+    QImage intermediate = input;
+    if (size.width() != input.width()) {
+        Coefficients horizontal = coefficients(input.width(), size.width(), filter);
+        intermediate = FramePool::globalInstance()->allocate(QSize(size.width(), input.height()),
+                                                             input.format());
+        if (intermediate.isNull())
+            return intermediate;
+
+        destination = destinationOf(intermediate);
+        rows = intermediate.height();
+        for (band = 1; band < qMin(bands, rows); band++) {
+            running.append(QtConcurrent::run(resampleRows, &input, &destination, &horizontal,
+                                             rows * band / qMin(bands, rows),
+                                             rows * (band + 1) / qMin(bands, rows)));
+        }
+        // The first band is computed in this thread
+        resampleRows(&input, &destination, &horizontal, 0, rows / qMin(bands, rows));
+        foreach (QFuture<void> future, running)
+            future.waitForFinished();
+        running.clear();
+    }
+
+    if (size.height() == intermediate.height())
+        return intermediate;
+
+    // Vertical pass
+    Coefficients vertical = coefficients(intermediate.height(), size.height(), filter);
+    QImage output = FramePool::globalInstance()->allocate(size, input.format());
+    if (output.isNull())
+        return output;
+
+    destination = destinationOf(output);
+    rows = output.height();
+    for (band = 1; band < qMin(bands, rows); band++) {
+        running.append(QtConcurrent::run(resampleColumns, &intermediate, &destination, &vertical,
+                                         rows * band / qMin(bands, rows),
+                                         rows * (band + 1) / qMin(bands, rows)));
+    }
+    resampleColumns(&intermediate, &destination, &vertical, 0, rows / qMin(bands, rows));
+    foreach (QFuture<void> future, running)
+        future.waitForFinished();
+
+    return output;
+}
+
+/** \brief Computes the weights to resample sourceSize pixels into destinationSize pixels.
+
+  Pixel centers are at +0.5. The weights of every destination pixel add up to exactly
+  1 << PRECISION_BITS, so that plain colors stay unchanged.
+*/
+Resampler::Coefficients Resampler::coefficients(int sourceSize, int destinationSize, Filter filter)
+{
+    Coefficients result;
+    qreal scale = (qreal) sourceSize / destinationSize;
+    // When reducing, the filter covers all source pixels of a destination pixel
+    qreal filterScale = qMax(scale, qreal(1.0));
+    qreal (*function)(qreal);
+    qreal support;
+    int i, k;
+
+    if (scale > AREA_REDUCTION) {
+        function = boxFilter;
+        support = 0.5;
+    } else if (filter == Lanczos3Filter) {
+        function = lanczos3Filter;
+        support = 3.0;
+    } else {
+        function = bicubicFilter;
+        support = 2.0;
+    }
+    support *= filterScale;
+
+    result.window = qCeil(support) * 2 + 1;
+    result.first.resize(destinationSize);
+    result.count.resize(destinationSize);
+    result.weights.fill(0, destinationSize * result.window);
+
+    QVarLengthArray<qreal, 64> weights(result.window);
+    for (i = 0; i < destinationSize; i++) {
+        qreal center = (i + 0.5) * scale;
+        int first = qMax(int(center - support + 0.5), 0);
+        int last = qMin(int(center + support + 0.5), sourceSize);
+        int count = qMin(qMax(last - first, 1), result.window);
+        qreal total = 0;
+
+        first = qMin(first, sourceSize - count);
+        for (k = 0; k < count; k++) {
+            weights[k] = function((first + k - center + 0.5) / filterScale);
+            total += weights[k];
+        }
+        if (total == 0)
+            total = 1;
+
+        // The rounding error goes to the largest weight
+        qint16 *fixed = result.weights.data() + i * result.window;
+        int sum = 0;
+        int largest = 0;
+        for (k = 0; k < count; k++) {
+            fixed[k] = qint16(qRound(weights[k] / total * (1 << PRECISION_BITS)));
+            sum += fixed[k];
+            if (fixed[k] > fixed[largest])
+                largest = k;
+        }
+        fixed[largest] += (1 << PRECISION_BITS) - sum;
+
+        result.first[i] = first;
+        result.count[i] = count;
+    }
+    return result;
+}
+
+Resampler::Destination Resampler::destinationOf(QImage &image)
+{
+    Destination destination;
+    destination.bits = image.bits();
+    destination.bytesPerLine = image.bytesPerLine();
+    destination.width = image.width();
+    destination.alpha = image.format() == QImage::Format_ARGB32_Premultiplied;
+    return destination;
+}
+
+// Resamples the rows [firstRow, lastRow[ of source horizontally into destination.
+// Runs in a worker thread: each thread writes its own rows of destination.
+void Resampler::resampleRows(const QImage *source, const Destination *destination,
+                             const Coefficients *horizontal, int firstRow, int lastRow)
+{
+    bool alpha = destination->alpha;
+    int width = destination->width;
+    int x, y, k;
+
+    for (y = firstRow; y < lastRow; y++) {
+        const uint *in = reinterpret_cast<const uint *>(source->constScanLine(y));
+        uint *out = reinterpret_cast<uint *>(destination->bits + y * destination->bytesPerLine);
+        for (x = 0; x < width; x++) {
+            const uint *pixels = in + horizontal->first[x];
+            const qint16 *weights = horizontal->weights.constData() + x * horizontal->window;
+            int count = horizontal->count[x];
+            Sums sums = initialSums();
+
+            for (k = 0; k + 1 < count; k += 2)
+                sums = addPixels(sums, pixels[k], pixels[k + 1], weights[k], weights[k + 1]);
+            if (k < count)
+                sums = addPixels(sums, pixels[k], 0, weights[k], 0);
+
+            out[x] = alpha ? premultiplied(toPixel(sums)) : toPixel(sums);
+        }
+    }
+}
+
+// Resamples source vertically into the rows [firstRow, lastRow[ of destination.
+// Runs in a worker thread: each thread writes its own rows of destination.
+void Resampler::resampleColumns(const QImage *source, const Destination *destination,
+                                const Coefficients *vertical, int firstRow, int lastRow)
+{
+    bool alpha = destination->alpha;
+    int width = destination->width;
+    int x, y, k;
+    QVarLengthArray<const uint *, 64> lines(vertical->window);
+
+    for (y = firstRow; y < lastRow; y++) {
+        const qint16 *weights = vertical->weights.constData() + y * vertical->window;
+        int count = vertical->count[y];
+        for (k = 0; k < count; k++)
+            lines[k] = reinterpret_cast<const uint *>(source->constScanLine(vertical->first[y] + k));
+
+        uint *out = reinterpret_cast<uint *>(destination->bits + y * destination->bytesPerLine);
+        for (x = 0; x < width; x++) {
+            Sums sums = initialSums();
+
+            for (k = 0; k + 1 < count; k += 2)
+                sums = addPixels(sums, lines[k][x], lines[k + 1][x], weights[k], weights[k + 1]);
+            if (k < count)
+                sums = addPixels(sums, lines[k][x], 0, weights[k], 0);
+
+            out[x] = alpha ? premultiplied(toPixel(sums)) : toPixel(sums);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <QImage>
+#include <QSize>
+#include <QVector>
+
+/* Resizes images with a separable filter.
+
+  The image is resampled horizontally, then vertically. For every destination column
+  (and row) the weights of the source pixels are computed once, in fixed point, so the
+  inner loops only multiply and add integers (4 channels at once with SSE2). The rows are
+  processed by all processor cores.
+
+  When reducing, the filter is stretched over all the source pixels covered by a
+  destination pixel, so that thin lines (text) do not alias. Reductions by more than
+  AREA_REDUCTION use the area average, which gives the same result at a lower cost.
+*/
+class Resampler
+{
+public:
+    enum Filter { BicubicFilter, Lanczos3Filter };
+
+    static QImage resize(const QImage &image, QSize size, Filter filter);
+
+private:
+    /* Weights of the source pixels for each destination pixel along one axis.
+       Destination pixel i uses the source pixels first[i] .. first[i] + count[i] - 1, with
+       weights weights[i * window] .. */
+    struct Coefficients
+    {
+        QVector<int> first;
+        QVector<int> count;
+        QVector<qint16> weights;
+        int window = 0;
+    };
+
+    /* The rows of the destination image, taken once by resize(): the bands must not call
+       the non-const QImage functions. */
+    struct Destination
+    {
+        uchar *bits;
+        int bytesPerLine;
+        int width;
+        bool alpha;
+    };
+
+    static Destination destinationOf(QImage &image);
+
+    static Coefficients coefficients(int sourceSize, int destinationSize, Filter filter);
+    static void resampleRows(const QImage *source, const Destination *destination,
+                             const Coefficients *horizontal, int firstRow, int lastRow);
+    static void resampleColumns(const QImage *source, const Destination *destination,
+                                const Coefficients *vertical, int firstRow, int lastRow);
+};
+
+#endif // RESAMPLER_H
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stagelog.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTextStream>
+
+StageLog::StageLog()
+{
+    // The signal must be delivered in the GUI thread, whatever thread creates the instance.
+    if (QCoreApplication::instance())
+        moveToThread(QCoreApplication::instance()->thread());
+}
+
+StageLog::~StageLog()
+{
+    flush();
+}
+
+StageLog *StageLog::globalInstance()
+{
+    static StageLog instance;
+    return &instance;
+}
+
+/** \brief Adds the duration of stage to the timings of page, if page is recorded. */
+void StageLog::record(QString page, QString stage, qint64 nanoseconds)
+{
+    QString currentSummary;
+    StageTiming timing;
+
+    timing.stage = stage;
+    timing.nanoseconds = nanoseconds;
+
+    mutex.lock();
+    bool isCurrent = (page == current);
+    // Without log file, only the summary of the current page is shown.
+    if (!isCurrent && !(logFile.isOpen() && started.contains(page))) {
+        mutex.unlock();
+        return;
+    }
+    QList<StageTiming> &timings = pages[page];
+    bool replaced = false;
+    // Without log file, the summary only needs the last duration of each stage.
+    if (!logFile.isOpen()) {
+        for (int i = 0; i < timings.size() && !replaced; i++) {
+            if (timings[i].stage == stage) {
+                timings[i] = timing;
+                replaced = true;
+            }
+        }
+    }
+    if (!replaced)
+        timings.append(timing);
+    if (isCurrent)
+        currentSummary = summary(timings);
+    mutex.unlock();
+
+    if (isCurrent)
+        emit timingsChanged(currentSummary);
+}
+
+/** \brief Sets the page displayed by the GUI; the previous one is finished.
+
+  The timings of other pages that were not started (see startPage()) are dropped.
+*/
+void StageLog::setCurrentPage(QString page)
+{
+    QString previous;
+
+    mutex.lock();
+    previous = current;
+    current = page;
+    mutex.unlock();
+
+    if (previous != page)
+        finishPage(previous);
+
+    mutex.lock();
+    foreach (QString unfinished, pages.keys()) {
+        if (unfinished != current && !started.contains(unfinished))
+            pages.remove(unfinished);
+    }
+    mutex.unlock();
+    emit timingsChanged(summary());
+}
+
+QString StageLog::currentPage()
+{
+    QMutexLocker locker(&mutex);
+    return current;
+}
+
+/** \brief Records the timings of page, which is not displayed, until finishPage().
+
+  The timings are only recorded when there is a log file.
+*/
+void StageLog::startPage(QString page)
+{
+    QMutexLocker locker(&mutex);
+    if (logFile.isOpen())
+        started.insert(page);
+}
+
+/** \brief Writes the timings of page to the log file and forgets them. */
+void StageLog::finishPage(QString page)
+{
+    QMutexLocker locker(&mutex);
+    started.remove(page);
+    if (pages.contains(page))
+        writePage(page, pages.take(page));
+}
+
+/** \brief Returns the timings of the current page, as "Decode 120 ms, Rotation 35 ms". */
+QString StageLog::summary()
+{
+    QMutexLocker locker(&mutex);
+    return summary(pages.value(current));
+}
+
+// The last duration of each stage, in the order the stages were first computed
+QString StageLog::summary(const QList<StageTiming> &timings)
+{
+    QStringList stages;
+    QMap<QString, qint64> lastDuration;
+
+    foreach (StageTiming timing, timings) {
+        if (!lastDuration.contains(timing.stage))
+            stages.append(timing.stage);
+        lastDuration[timing.stage] = timing.nanoseconds;
+    }
+
+    QStringList parts;
+    foreach (QString stage, stages)
+        parts.append(QString("%1 %2 ms").arg(stage).arg(lastDuration[stage] / 1000000.0, 0, 'f', 1));
+    return parts.join(", ");
+}
+
+/** \brief Writes the timings of the next finished pages to fileName.
+
+  The file is JSON (one object per line) if fileName ends with .json, CSV otherwise. New
+  lines are appended to an existing file. An empty fileName closes the log.
+*/
+bool StageLog::setLogFile(QString fileName)
+{
+    QMutexLocker locker(&mutex);
+
+    if (logFile.isOpen())
+        logFile.close();
+    if (fileName.isEmpty())
+        return true;
+
+    logFile.setFileName(fileName);
+    json = fileName.endsWith(".json", Qt::CaseInsensitive);
+    bool newFile = !logFile.exists() || logFile.size() == 0;
+    if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return false;
+    if (newFile && !json)
+        logFile.write("time,page,stage,milliseconds\n");
+    return true;
+}
+
+/** \brief Opens the log file given by the environment variable YASW_TIMING_LOG, if set. */
+bool StageLog::openDefaultLog()
+{
+    QString fileName = QString::fromLocal8Bit(qgetenv("YASW_TIMING_LOG"));
+    if (fileName.isEmpty())
+        return false;
+    return setLogFile(fileName);
+}
+
+/** \brief Writes all pages not finished yet, for example before the program exits. */
+void StageLog::flush()
+{
+    QMutexLocker locker(&mutex);
+    foreach (QString page, pages.keys())
+        writePage(page, pages.take(page));
+    if (logFile.isOpen())
+        logFile.flush();
+}
+
+// Called with mutex locked
+void StageLog::writePage(QString page, const QList<StageTiming> &timings)
+{
+    if (!logFile.isOpen() || timings.isEmpty())
+        return;
+
+    QString time = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    if (json) {
+        QJsonObject pageObject;
+        QJsonArray stages;
+        qint64 total = 0;
+        foreach (StageTiming timing, timings) {
+            QJsonObject stage;
+            stage["stage"] = timing.stage;
+            stage["milliseconds"] = timing.nanoseconds / 1000000.0;
+            stages.append(stage);
+            total += timing.nanoseconds;
+        }
+        pageObject["time"] = time;
+        pageObject["page"] = page;
+        pageObject["stages"] = stages;
+        pageObject["milliseconds"] = total / 1000000.0;
+        logFile.write(QJsonDocument(pageObject).toJson(QJsonDocument::Compact) + "\n");
+    } else {
+        QTextStream out(&logFile);
+        // Quote the page: file names may contain commas.
+        QString quotedPage = "\"" + QString(page).replace("\"", "\"\"") + "\"";
+        foreach (StageTiming timing, timings) {
+            out << time << "," << quotedPage << "," << timing.stage << ","
+                << QString::number(timing.nanoseconds / 1000000.0, 'f', 3) << "\n";
+        }
+    }
+}
+
+StageTimer::StageTimer(QString stage, QString page) : stage(stage), page(page)
+{
+    // QElapsedTimer uses a monotonic clock where the system has one.
+    timer.start();
+}
+
+StageTimer::~StageTimer()
+{
+    StageLog::globalInstance()->record(page, stage, timer.nsecsElapsed());
+}
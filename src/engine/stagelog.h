@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STAGELOG_H
+#define STAGELOG_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+/* Duration of one stage of the computation of a page. */
+struct StageTiming
+{
+    QString stage;
+    qint64 nanoseconds;
+};
+
+/* Collects the time spent in each stage of the computation of each page.
+
+  Durations are measured with StageTimer and grouped by page. Only the page displayed by
+  the GUI (setCurrentPage()) and, when there is a log file, the pages between startPage()
+  and finishPage() are recorded; the durations of other pages (a page computed in the
+  background, or a job finishing after another page was selected) are ignored.
+  The displayed page is finished when another page is selected. Finished pages are written
+  to the log file, if any: one line per page in JSON (when the file name ends with .json),
+  else one line per stage in CSV. The log file is opt-in, see openDefaultLog().
+
+  timingsChanged() gives a summary of the current page, for the status bar. The StageLog
+  may be used from any thread; its signal is emitted in the thread of the application.
+*/
+class StageLog : public QObject
+{
+    Q_OBJECT
+public:
+    static StageLog *globalInstance();
+
+    void record(QString page, QString stage, qint64 nanoseconds);
+    void setCurrentPage(QString page);
+    QString currentPage();
+    void startPage(QString page);
+    void finishPage(QString page);
+    QString summary();
+
+    bool setLogFile(QString fileName);
+    bool openDefaultLog();
+    void flush();
+
+signals:
+    void timingsChanged(QString summary);
+
+private:
+    StageLog();
+    ~StageLog();
+    void writePage(QString page, const QList<StageTiming> &timings);
+    static QString summary(const QList<StageTiming> &timings);
+
+    QMutex mutex;
+    QString current;
+    // timings of the pages not finished yet
+    QMap<QString, QList<StageTiming> > pages;
+    // pages between startPage() and finishPage()
+    QSet<QString> started;
+    QFile logFile;
+    bool json = false;
+};
+
+/* Measures the time until it is destroyed with a monotonic clock, and records it
+   in the StageLog for stage and page. */
+class StageTimer
+{
+public:
+    StageTimer(QString stage, QString page);
+    ~StageTimer();
+
+private:
+    QString stage;
+    QString page;
+    QElapsedTimer timer;
+};
+
+#endif // STAGELOG_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnailloader.h"
+#include "imagecache.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QImageReader>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QDir>
+
+ThumbnailLoader::ThumbnailLoader(int width, QObject *parent) :
+    QObject(parent),
+    width(width)
+{
+}
+
+ThumbnailLoader::~ThumbnailLoader()
+{
+    cancel();
+}
+
+/** \brief Queues the decoding of the thumbnail of fileName.
+*/
+void ThumbnailLoader::request(QString fileName)
+{
+    if (fileName.isEmpty())
+        return;
+
+    QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+    watcher->setProperty("fileName", fileName);
+    connect(watcher, SIGNAL(finished()),
+            this, SLOT(thumbnailFinished()));
+    watcher->setFuture(QtConcurrent::run(&pool, ThumbnailLoader::loadThumbnail, fileName, width));
+}
+
+/** \brief Forgets the thumbnails not yet started and waits for the running ones.
+
+  No thumbnailReady() signal is emitted for the pending requests.
+*/
+void ThumbnailLoader::cancel()
+{
+    pool.clear();
+    pool.waitForDone();
+
+    QList<QFutureWatcher<QImage> *> watchers = findChildren<QFutureWatcher<QImage> *>();
+    QFutureWatcher<QImage> *watcher;
+    foreach (watcher, watchers) {
+        watcher->disconnect(this);
+        delete watcher;
+    }
+}
+
+void ThumbnailLoader::thumbnailFinished()
+{
+    QFutureWatcher<QImage> *watcher = static_cast<QFutureWatcher<QImage> *>(sender());
+
+    emit thumbnailReady(watcher->property("fileName").toString(), watcher->result());
+    watcher->deleteLater();
+}
+
+/** \brief Returns the thumbnail of fileName, from the disk cache if possible.
+
+  This function is thread safe.
+*/
+QImage ThumbnailLoader::loadThumbnail(QString fileName, int width)
+{
+    QString cacheFile = cacheFileName(fileName, width);
+    QImage thumbnail(cacheFile);
+    if (!thumbnail.isNull())
+        return thumbnail;
+
+    thumbnail = decodeThumbnail(fileName, width);
+    if (thumbnail.isNull())
+        return thumbnail;
+
+    // QSaveFile: a thumbnail written at the same time for another item is never seen half written.
+    QDir().mkpath(cacheDirectory());
+    QSaveFile file(cacheFile);
+    if (file.open(QIODevice::WriteOnly)
+            && thumbnail.save(&file, "JPG", 90)) {
+        file.commit();
+    }
+    return thumbnail;
+}
+
+/** \brief Directory of the thumbnail cache (~/.cache/yasw/thumbnails on Linux) */
+QString ThumbnailLoader::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/yasw/thumbnails";
+}
+
+/* The name of a cached thumbnail changes when the source file is replaced or modified. */
+QString ThumbnailLoader::cacheFileName(QString fileName, int width)
+{
+    QByteArray key = ImageCache::sourceKey(fileName);
+    return QString("%1/%2-%3.jpg").arg(cacheDirectory())
+            .arg(QString(key.toHex()))
+            .arg(width);
+}
+
+/** \brief Decodes fileName directly at the given width.
+*/
+QImage ThumbnailLoader::decodeThumbnail(QString fileName, int width)
+{
+    QImageReader reader(fileName);
+    QSize size = reader.size();
+
+    if (size.isValid()) {
+        reader.setScaledSize(size.scaled(width, size.height(), Qt::KeepAspectRatio));
+        return reader.read();
+    }
+
+    // The format does not know its size before decoding
+    QImage image = reader.read();
+    if (image.isNull())
+        return image;
+    return image.scaledToWidth(width, Qt::SmoothTransformation);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef THUMBNAILLOADER_H
+#define THUMBNAILLOADER_H
+
+#include <QObject>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+#include <QFutureWatcher>
+
+/* Computes thumbnails of image files in background threads.
+
+  request() returns immediately; thumbnailReady() is emitted in the thread of the
+  ThumbnailLoader (the GUI thread) for each thumbnail as soon as it is decoded.
+  The files are decoded with QImageReader::setScaledSize(), which lets the JPEG
+  decoder skip most of the work (DCT scaling down to 1/8) instead of decoding the
+  full image to throw most of it away.
+
+  Thumbnails are also stored on disk, in the XDG cache directory (see cacheDirectory()),
+  keyed by path, size and modification time of the file. Reopening a project then only
+  reads these small files instead of the scans.
+*/
+class ThumbnailLoader : public QObject
+{
+    Q_OBJECT
+public:
+    ThumbnailLoader(int width, QObject *parent = 0);
+    ~ThumbnailLoader();
+    void request(QString fileName);
+    void cancel();
+
+    static QImage loadThumbnail(QString fileName, int width);
+    static QString cacheDirectory();
+
+signals:
+    void thumbnailReady(QString fileName, QImage thumbnail);
+
+private slots:
+    void thumbnailFinished();
+
+private:
+    static QString cacheFileName(QString fileName, int width);
+    static QImage decodeThumbnail(QString fileName, int width);
+    int width;
+    // own pool, so that thumbnails do not wait for an export using the global pool
+    QThreadPool pool;
+};
+
+#endif // THUMBNAILLOADER_H
@@ -25,3 +25,30 @@ AbstractFilterWidget::AbstractFilterWidget(QWidget *parent) :
     QWidget(parent)
 {
 }
+
+/** \brief Sets the size of the images given to setImage() and setPreview() relative to
+  the scanned image.
+*/
+void AbstractFilterWidget::setProxyScale(qreal scale)
+{
+    proxyScale = scale;
+}
+
+/** \brief Sets an output image for preview in another resolution than proxyScale.
+
+  Used for the drafts computed while dragging (see BaseFilter::refreshDraft()).
+*/
+void AbstractFilterWidget::setDraftPreview(QImage image, qreal scale)
+{
+    qreal previewScale = proxyScale;
+    proxyScale = scale;
+    setPreview(image);
+    proxyScale = previewScale;
+}
+
+/** \brief Returns the size image would have in the resolution of the scanned image.
+*/
+QSize AbstractFilterWidget::fullResolutionSize(const QImage &image)
+{
+    return QSize(qRound(image.width() / proxyScale), qRound(image.height() / proxyScale));
+}
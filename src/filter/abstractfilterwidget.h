@@ -20,6 +20,7 @@
 #define ABSTRACTFILTERWIDGET_H
 
 #include <QWidget>
+#include <QImage>
 
 
 /* An abstract class for all Filter Widgets.
@@ -28,10 +29,17 @@
   It has to be inherited by all Filter Widgets.
 
   A Filter Widget must provide a way to
-  setPixmap - set the input image (for displaying it)
+  setImage - set the input image (for displaying it)
   setPreview - set the output image (for previewing the result)
   preview - inform if the preview is active
   parameterChanged - inform if parameter have been changed in the widget
+
+  Images are given as QImage; they are only converted to a QPixmap by the
+  graphics view which displays them.
+
+  While editing, the images may be a proxy of the scanned image, reduced by proxyScale
+  (see FilterContainer). The views display them so that scene coordinates, and so all
+  settings, stay in the resolution of the scanned image.
 */
 
 
@@ -40,20 +48,30 @@ class AbstractFilterWidget : public QWidget
     Q_OBJECT
 public:
     AbstractFilterWidget(QWidget *parent = 0);
-    // Sets the input pixmap
-    virtual void setPixmap(QPixmap pixmap) = 0;
-    // Sets the output pixmap for preview
-    virtual void setPreview(QPixmap pixmap) = 0;
+    // Sets the input image
+    virtual void setImage(QImage image) = 0;
+    // Sets the output image for preview
+    virtual void setPreview(QImage image) = 0;
     // true if preview is active
     virtual bool preview() = 0;
     virtual void enableFilter(bool enable) = 0;
+    void setProxyScale(qreal scale);
+    void setDraftPreview(QImage image, qreal scale);
 protected:
-    QPixmap inputPixmap;
-    QPixmap previewPixmap;
+    QSize fullResolutionSize(const QImage &image);
+    QImage inputImage;
+    QImage previewImage;
+    // size of the displayed images relative to the scanned image (1 = full resolution)
+    qreal proxyScale = 1.0;
 signals:
     void parameterChanged();
     void enableFilterToggled(bool checked);
     void previewChecked();
+    // the view was zoomed beyond the resolution of the proxy image
+    void fullResolutionRequested();
+    // the user drags a corner: updates until dragFinished() are only drafts
+    void dragStarted();
+    void dragFinished();
 
 };
 
@@ -19,13 +19,20 @@
 
 #include "constants.h"
 #include "basefilter.h"
+#include "imagecache.h"
+#include "filterengine.h"
+#include "framepool.h"
+#include "stagelog.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QtConcurrent/QtConcurrentRun>
 
 /*! \class BaseFilter
 
   \brief The BaseFilter class is the model for all Filter applied on pages.
 
   It should be inherited by every Filter. The PageFilter class is functional but does nothing, and
-  returns the pixmap unmodified.
+  returns the image unmodified.
 
   Some functions are definied as virtual in order to allow the calling class use a unique interface
   (all Filter can be stored as a "BaseFilter" Class).
@@ -37,34 +44,64 @@ BaseFilter::BaseFilter(QObject * parent) : QObject(parent)
 {
     widget = new BaseFilterWidget();
     filterWidget = widget;
+
+    qreal refreshRate = 60;
+    if (QGuiApplication::primaryScreen() && QGuiApplication::primaryScreen()->refreshRate() > 0)
+        refreshRate = QGuiApplication::primaryScreen()->refreshRate();
+    draftTimer.setSingleShot(true);
+    draftTimer.setInterval(qRound(1000 / refreshRate));
+    connect(&draftTimer, SIGNAL(timeout()),
+            this, SLOT(refreshDraft()));
+
+    connect(this, SIGNAL(parameterChanged()),
+            this, SLOT(invalidate()));
+    connect(&recomputeWatcher, SIGNAL(finished()),
+            this, SLOT(recomputeFinished()));
 }
 
 BaseFilter::~BaseFilter()
 {
+    // The worker reads generation: cancel it and wait before it is destroyed.
+    generation.ref();
+    recomputeWatcher.waitForFinished();
     delete widget;
 }
 
 
 /*! \brief Set input Page
 
-  This function is called by the calling class to set the Pixmap to be "filtered".
+  This function is called by the calling class to set the image to be "filtered".
+  key identifies the image in the ImageCache; if it is empty, the output is not cached.
 */
-void BaseFilter::setImage(QPixmap pixmap)
+void BaseFilter::setImage(QImage image, QByteArray key)
 {
-    inputPixmap = pixmap;
+    inputImage = image;
+    inputKey = key;
     emit parameterChanged();
-    filterWidget->setPixmap(pixmap);
+    filterWidget->setImage(image);
     mustRecalculate = true;
 }
 
 /*! \brief Returns the transformed image
 
-  @returns The transformed page, or a null Pixmap if no page is available
+  @returns The transformed page, or a null image if no page is available
 */
-QPixmap BaseFilter::getOutputImage()
+QImage BaseFilter::getOutputImage()
 {
-    refresh();
-    return outputPixmap;
+    refreshNow();
+    return outputImage;
+}
+
+/*! \brief Returns the key of the output image in the ImageCache
+
+  The key depends on the input image and on all settings of this filter, so that the
+  output computed for a page can be reused when coming back to it.
+*/
+QByteArray BaseFilter::outputKey()
+{
+    QMap<QString, QVariant> settings = getSettings();
+    settings["proxyScale"] = proxyScale;
+    return ImageCache::stageKey(inputKey, getIdentifier(), settings);
 }
 
 /*! \brief Gets the widget to display the filter
@@ -108,8 +145,56 @@ void BaseFilter::widgetParameterChanged()
     mustRecalculate = true;
     // Only refresh the output image if preview is active
     if (filterWidget->preview()) {
+        // Coalesce the moves of a drag into one draft per screen refresh.
+        if (dragging) {
+            if (!draftTimer.isActive())
+                draftTimer.start();
+        } else {
+            refresh();
+        }
+    }
+}
+
+void BaseFilter::dragStarted()
+{
+    dragging = true;
+}
+
+/** \brief Computes the full quality output once the drag is over. */
+void BaseFilter::dragFinished()
+{
+    dragging = false;
+    draftTimer.stop();
+    if (filterWidget->preview())
         refresh();
+}
+
+/** \brief Previews a draft of the output while a corner is dragged.
+
+  The draft is computed from the input reduced to the size of the view: when the user
+  zoomed in, the input is in full resolution and would be far too slow to compute at each
+  move. The draft is not cached.
+*/
+void BaseFilter::refreshDraft()
+{
+    if (!dragging || !filterWidget->preview() || loadingSettings)
+        return;
+
+    if (inputImage.cacheKey() != draftInputKey) {
+        QSizeF viewSize = QSizeF(filterWidget->size()) * filterWidget->devicePixelRatioF();
+        draftScale = FilterEngine::proxyScale(inputImage.size(), viewSize);
+        draftInput = FilterEngine::proxyImage(inputImage, draftScale);
+        draftInputKey = inputImage.cacheKey();
     }
+
+    // filter() applies the settings scaled to proxyScale.
+    qreal inputScale = proxyScale;
+    proxyScale = inputScale * draftScale;
+    FramePool::Stage stage(getIdentifier() + " draft");
+    QImage draft = filter(draftInput);
+    proxyScale = inputScale;
+
+    filterWidget->setDraftPreview(draft, inputScale * draftScale);
 }
 
 void BaseFilter::enableFilterToggled(bool checked)
@@ -125,8 +210,11 @@ void BaseFilter::enableFilterToggled(bool checked)
 
 void BaseFilter::previewChecked()
 {
-    refresh();
-    filterWidget->setPreview(outputPixmap);
+    // An out of date output is shown by recomputeFinished() once it is computed.
+    if (mustRecalculate || reloadInputImage)
+        refresh();
+    else
+        filterWidget->setPreview(outputImage);
 }
 
 /*! \brief virtual function to get the Filter settings
@@ -150,22 +238,6 @@ void BaseFilter::setSettings(QMap<QString, QVariant> /* settings */)
     //    loadingSettings = false;
 }
 
-// Dummy function that create a node for filter that do not implement this virtual function
-void BaseFilter::settings2Dom(QDomDocument &doc, QDomElement &imageElement, QMap<QString, QVariant> /* settings */)
-{
-    QDomElement filterElement = doc.createElement(getIdentifier());
-    QDomComment commentElement = doc.createComment("Created by BaseFilter");
-    imageElement.appendChild(filterElement);
-    filterElement.appendChild(commentElement);
-    return;
-}
-
-QMap<QString, QVariant> BaseFilter::dom2Settings(QDomElement & /* filterElement */)
-{
-    /* As BaseFilter does nothing, there are no settings to transform */
-    return QMap<QString, QVariant>();
-}
-
 void BaseFilter::setPreviousFilter(BaseFilter *filter)
 {
     previousFilter = filter;
@@ -173,33 +245,171 @@ void BaseFilter::setPreviousFilter(BaseFilter *filter)
     inputImageChanged();
 }
 
+void BaseFilter::setRecomputePool(QThreadPool *pool)
+{
+    recomputePool = pool;
+}
+
 void BaseFilter::enableFilter(bool enable)
 {
     filterEnabled = enable;
     filterWidget->enableFilter(enable);
 }
 
+/** \brief Sets the resolution of the images passed through the filters.
+
+  The interactive preview works on a proxy of the scanned image reduced by scale. The settings
+  stay in the resolution of the scanned image; filter() must scale them before computing.
+*/
+void BaseFilter::setProxyScale(qreal scale)
+{
+    proxyScale = scale;
+    filterWidget->setProxyScale(scale);
+    mustRecalculate = true;
+}
+
+/** \brief Recomputes the output image in the background if anything changed.
+
+  The filters whose input is out of date are computed in a worker thread, from the last
+  filter with an up to date input up to this one. Meanwhile the widgets keep showing their
+  last images. A newer change (of any of these filters, or a new page) makes the running
+  computation stop at the next filter and its results are dropped.
+*/
 void BaseFilter::refresh()
+{
+    if (loadingSettings)
+        return;
+    if (!recomputePool) {
+        refreshNow();
+        return;
+    }
+
+    QList<BaseFilter *> chain;
+    BaseFilter *filter = this;
+    bool changed = false;
+
+    forever {
+        chain.prepend(filter);
+        changed = changed || filter->mustRecalculate || filter->reloadInputImage;
+        if (!filter->reloadInputImage || !filter->previousFilter)
+            break;
+        filter = filter->previousFilter;
+    }
+
+    // Nothing to do, or the same computation is already running.
+    if (!changed || (recomputeWatcher.isRunning() && runningGeneration == generation.load()))
+        return;
+
+    RecomputeJob job;
+    job.inputImage = chain.first()->inputImage;
+    job.inputKey = chain.first()->inputKey;
+    job.page = StageLog::globalInstance()->currentPage();
+    job.filters = chain;
+    foreach (filter, chain) {
+        job.generations.append(filter->generation.load());
+        job.identifiers.append(filter->getIdentifier());
+        job.settings.append(filter->getSettings());
+        job.proxyScales.append(filter->proxyScale);
+    }
+
+    runningGeneration = generation.load();
+    recomputeWatcher.setFuture(QtConcurrent::run(recomputePool, &BaseFilter::recompute,
+                                                 job, &generation, runningGeneration));
+}
+
+/* Computes the output image now, in the calling thread. */
+void BaseFilter::refreshNow()
 {
     if (loadingSettings)
         return;
 
     if (reloadInputImage && previousFilter) {
-        setImage(previousFilter->getOutputImage());
+        QImage image = previousFilter->getOutputImage();
+        setImage(image, previousFilter->outputKey());
         reloadInputImage = false;
         mustRecalculate = true;
     }
     if (mustRecalculate) {
-        outputPixmap = QPixmap::fromImage(filter(inputPixmap.toImage()));
+        QByteArray key = outputKey();
+        if (!ImageCache::globalInstance()->find(key, &outputImage)) {
+            FramePool::Stage stage(getIdentifier());
+            StageTimer timer(getIdentifier(), StageLog::globalInstance()->currentPage());
+            outputImage = filter(inputImage);
+            ImageCache::globalInstance()->insert(key, outputImage);
+        }
         mustRecalculate = false;
-        filterWidget->setPreview(outputPixmap);
+        filterWidget->setPreview(outputImage);
+    }
+}
+
+// Runs in the worker thread: only FilterEngine and ImageCache may be used here.
+RecomputeJob BaseFilter::recompute(RecomputeJob job, const QAtomicInt *generation, int jobGeneration)
+{
+    QImage image = job.inputImage;
+    QByteArray key = job.inputKey;
+    QMap<QString, QVariant> keySettings;
+    int index;
+
+    for (index = 0; index < job.identifiers.size(); index++) {
+        if (generation->load() != jobGeneration)
+            break;
+
+        // Same key as outputKey()
+        keySettings = job.settings[index];
+        keySettings["proxyScale"] = job.proxyScales[index];
+        key = ImageCache::stageKey(key, job.identifiers[index], keySettings);
+
+        QImage output;
+        if (!ImageCache::globalInstance()->find(key, &output)) {
+            StageTimer timer(job.identifiers[index], job.page);
+            output = FilterEngine::renderStage(job.identifiers[index], image, job.settings[index],
+                                               job.proxyScales[index]);
+            ImageCache::globalInstance()->insert(key, output);
+        }
+        image = output;
+        job.outputImages.append(image);
+        job.outputKeys.append(key);
+    }
+    return job;
+}
+
+/* Shows the results of the worker in the filters which did not change since. */
+void BaseFilter::recomputeFinished()
+{
+    RecomputeJob job = recomputeWatcher.result();
+    BaseFilter *filter;
+    int index;
+
+    runningGeneration = -1;
+    for (index = 0; index < job.outputImages.size(); index++) {
+        filter = job.filters[index];
+        if (filter->generation.load() != job.generations[index])
+            break;
+
+        if (index > 0 && filter->reloadInputImage) {
+            filter->inputImage = job.outputImages[index - 1];
+            filter->inputKey = job.outputKeys[index - 1];
+            filter->filterWidget->setImage(filter->inputImage);
+            filter->reloadInputImage = false;
+            filter->mustRecalculate = true;
+        }
+        if (filter->mustRecalculate) {
+            filter->outputImage = job.outputImages[index];
+            filter->mustRecalculate = false;
+            filter->filterWidget->setPreview(filter->outputImage);
+        }
     }
 }
 
-// Do compute the outputPixmap with the help of all available parameters.
+void BaseFilter::invalidate()
+{
+    generation.ref();
+}
+
+// Do compute the outputImage with the help of all available parameters.
 void BaseFilter::compute()
 {
-    outputPixmap = QPixmap::fromImage(filter(inputPixmap.toImage()));
+    outputImage = filter(inputImage);
 }
 
 QImage BaseFilter::filter(QImage inputImage)
@@ -19,16 +19,43 @@
 #ifndef BASEFILTER_H
 #define BASEFILTER_H
 
-#include <QPixmap>
 #include <QWidget>
 #include <QObject>
 #include <QMap>
 #include <QVariant>
 #include <QString>
-#include <QtXml/QDomDocument>
 #include "basefilterwidget.h"
 #include <QImage>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QThreadPool>
 
+class BaseFilter;
+
+/* The part of the filter chain computed by the worker thread for BaseFilter::refresh().
+
+  The settings of each filter are read in the GUI thread, as they come from the widgets;
+  the worker only uses FilterEngine and the ImageCache.
+*/
+struct RecomputeJob
+{
+    QImage inputImage;
+    QByteArray inputKey;
+    // page of the StageLog
+    QString page;
+    // filters from the first one to compute up to the refreshed filter (only used in the GUI thread)
+    QList<BaseFilter *> filters;
+    // for each filter: its generation, identifier, settings and proxy scale when the job was started
+    QList<int> generations;
+    QStringList identifiers;
+    QList<QMap<QString, QVariant> > settings;
+    QList<qreal> proxyScales;
+    // results: outputs of the first filters, fewer than filters if the job was canceled
+    QList<QImage> outputImages;
+    QList<QByteArray> outputKeys;
+};
 
 class BaseFilter : public QObject
 {
@@ -36,8 +63,9 @@ class BaseFilter : public QObject
 public:
     BaseFilter(QObject * parent = 0);
     ~BaseFilter();
-    void setImage(const QPixmap pixmap);
-    virtual QPixmap getOutputImage();
+    void setImage(const QImage image, const QByteArray key = QByteArray());
+    virtual QImage getOutputImage();
+    QByteArray outputKey();
 
     AbstractFilterWidget* getWidget();
     virtual QString getIdentifier();
@@ -45,28 +73,34 @@ public:
 
     virtual QMap<QString, QVariant> getSettings();
     virtual void setSettings(QMap <QString, QVariant> settings);
-    virtual void settings2Dom(QDomDocument &doc, QDomElement &imageElement, QMap<QString, QVariant> settings);
-    virtual QMap<QString, QVariant> dom2Settings(QDomElement &filterElement);
 
     void setPreviousFilter(BaseFilter *filter);
+    void setRecomputePool(QThreadPool *pool);
     void enableFilter(bool enable);
+    void setProxyScale(qreal scale);
     void refresh();
 
 public slots:
     /* get the information from external classes that an external parameter changed.
-     * Next time getFilteredImage() is called, must reload the inputPixmap. */
+     * Next time getFilteredImage() is called, must reload the inputImage. */
     void inputImageChanged();
     /* Parameter for the Filter changed through user intercaction */
     void widgetParameterChanged();
     void enableFilterToggled(bool checked);
     void previewChecked();
+    void dragStarted();
+    void dragFinished();
 signals:
     /* Yell that my parameter (this includes input image) changed and that one need to reload my FilteredImage */
     void parameterChanged();
 
 protected:
-    QPixmap inputPixmap;
-    QPixmap outputPixmap;
+    /* Images are passed between filters as QImage (implicitly shared, so no copy is made);
+       only the widget's view converts them to a QPixmap for display. */
+    QImage inputImage;
+    QImage outputImage;
+    /* Identifies inputImage in the ImageCache (empty if the input is not cached) */
+    QByteArray inputKey;
     AbstractFilterWidget *filterWidget = NULL;
     /* Store the information that the input image has to be reloaded before producing the output image */
     bool reloadInputImage = false;
@@ -79,9 +113,34 @@ protected:
     virtual void compute();
     virtual QImage filter(QImage inputImage);
     bool filterEnabled = true; // default on all widgets
+    /* inputImage is the scanned image resized by proxyScale: pixel settings must be scaled too */
+    qreal proxyScale = 1.0;
+
+private slots:
+    void refreshDraft();
+    void invalidate();
+    void recomputeFinished();
 
 private:
+    void refreshNow();
+    static RecomputeJob recompute(RecomputeJob job, const QAtomicInt *generation, int jobGeneration);
+
     BaseFilterWidget* widget;
+    /* Incremented at each parameterChanged(), so also when a previous filter changed:
+       results computed for an older generation are stale. */
+    QAtomicInt generation;
+    int runningGeneration = -1;
+    QFutureWatcher<RecomputeJob> recomputeWatcher;
+    /* Worker thread of refresh(), owned by the FilterContainer. Without pool, refresh()
+       computes in the calling thread. */
+    QThreadPool *recomputePool = NULL;
+    /* While a corner is dragged, the preview is only updated at the screen refresh rate,
+       with a draft computed from an image of the size of the view. */
+    bool dragging = false;
+    QTimer draftTimer;
+    QImage draftInput;
+    qint64 draftInputKey = 0;
+    qreal draftScale = 1.0;
 
 
 };
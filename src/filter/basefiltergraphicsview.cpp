@@ -17,7 +17,9 @@
  * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "basefiltergraphicsview.h"
+#include "stagelog.h"
 #include <QWheelEvent>
+#include <QMouseEvent>
 #include <math.h>
 #include <QDebug>
 
@@ -44,6 +46,9 @@ BaseFilterGraphicsView::wheelEvent(QWheelEvent *event)
         int numSteps = numDegrees / 15;
         double factor = pow(1.125, numSteps);
         scale(factor, factor);
+        /* One pixel of the proxy image now covers more than one device pixel */
+        if (proxyScale < 1 && transform().m11() * devicePixelRatioF() > proxyScale)
+            emit proxyResolutionExceeded();
     }
     // If one would want to scroll horizintaly with Shift instead of Alt (Qt Default),
     // else if (event->modifiers().testFlag(Qt::ShiftModifier))
@@ -54,11 +59,76 @@ BaseFilterGraphicsView::wheelEvent(QWheelEvent *event)
     }
 }
 
-void BaseFilterGraphicsView::setPixmap(const QPixmap pixmap)
+/** \brief Sets the image to display.
+
+  The conversion to a QPixmap is the expensive part: it is only done if the view is
+  visible, else it is delayed until the view is shown (see showEvent()). So only
+  the filter in the current tab converts its image.
+
+  image may be a proxy reduced by proxyScale: it is then scaled back in the scene, so that
+  scene coordinates (and the items placed by the user) always are in the resolution of the
+  scanned image.
+*/
+void BaseFilterGraphicsView::setImage(const QImage image, qreal proxyScale)
+{
+    this->image = image;
+    this->proxyScale = proxyScale;
+    imageChanged = true;
+    if (isVisible())
+        showImage();
+}
+
+void BaseFilterGraphicsView::showEvent(QShowEvent *event)
 {
-    scene->setSceneRect(pixmap.rect());
+    QGraphicsView::showEvent(event);
+    if (imageChanged)
+        showImage();
+}
+
+void BaseFilterGraphicsView::showImage()
+{
+    QRectF oldRect = scene->sceneRect();
+    QRectF newRect(0, 0, image.width() / proxyScale, image.height() / proxyScale);
+    /* The same image in another resolution (the user zoomed past the proxy, or a draft is
+       shown while dragging): keep the zoom */
+    bool resolutionChanged = (proxyScale != shownProxyScale)
+            && qAbs(oldRect.width() - newRect.width()) < 2
+            && qAbs(oldRect.height() - newRect.height()) < 2;
+
+    QString page = StageLog::globalInstance()->currentPage();
+    QPixmap pixmap;
+    {
+        StageTimer timer("Pixmap", page);
+        pixmap = QPixmap::fromImage(image);
+    }
+
+    StageTimer timer("View", page);
+    scene->setSceneRect(newRect);
     pixmapItem->setPixmap(pixmap);
+    pixmapItem->setScale(1 / proxyScale);
+    shownProxyScale = proxyScale;
+    imageChanged = false;
 
     /* Zoom the QGraphicsView to fit the new Pixmap */
-    fitInView(pixmapItem, Qt::KeepAspectRatio);
+    if (!resolutionChanged)
+        fitInView(pixmapItem, Qt::KeepAspectRatio);
+}
+
+/** \brief Emits dragStarted() when the mouse grabs an item of the scene. */
+void BaseFilterGraphicsView::mousePressEvent(QMouseEvent *event)
+{
+    QGraphicsView::mousePressEvent(event);
+    if (!dragging && event->button() == Qt::LeftButton && scene->mouseGrabberItem()) {
+        dragging = true;
+        emit dragStarted();
+    }
+}
+
+void BaseFilterGraphicsView::mouseReleaseEvent(QMouseEvent *event)
+{
+    QGraphicsView::mouseReleaseEvent(event);
+    if (dragging && event->button() == Qt::LeftButton) {
+        dragging = false;
+        emit dragFinished();
+    }
 }
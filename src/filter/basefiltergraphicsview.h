@@ -21,17 +21,34 @@
 
 #include <QGraphicsView>
 #include <QGraphicsPixmapItem>
+#include <QImage>
 
 class BaseFilterGraphicsView : public QGraphicsView {
     Q_OBJECT
 public:
     BaseFilterGraphicsView(QWidget *parent);
     ~BaseFilterGraphicsView();
-    void setPixmap(const QPixmap pixmap);
+    void setImage(const QImage image, qreal proxyScale = 1.0);
+signals:
+    void proxyResolutionExceeded();
+    // an item of the scene (a corner) is dragged with the mouse
+    void dragStarted();
+    void dragFinished();
 protected:
     void wheelEvent(QWheelEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void showEvent(QShowEvent *event);
     QGraphicsScene *scene = NULL;
     QGraphicsPixmapItem *pixmapItem = NULL;
+private:
+    void showImage();
+    // Image to display; it is converted to a pixmap only when the view is visible.
+    QImage image;
+    qreal proxyScale = 1.0;
+    qreal shownProxyScale = 1.0;
+    bool imageChanged = false;
+    bool dragging = false;
 };
 
 #endif // BASEFILTERGRAPHICSVIEW_H
@@ -24,6 +24,8 @@ BaseFilterWidget::BaseFilterWidget(QWidget *parent) :
     ui(new Ui::BaseFilterWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
 }
 
 BaseFilterWidget::~BaseFilterWidget()
@@ -43,14 +45,14 @@ void BaseFilterWidget::changeEvent(QEvent *e)
     }
 }
 
-void BaseFilterWidget::setPixmap(QPixmap pixmap)
+void BaseFilterWidget::setImage(QImage image)
 {
-    ui->view->setPixmap(pixmap);
+    ui->view->setImage(image, proxyScale);
 }
 
-void BaseFilterWidget::setPreview(QPixmap pixmap)
+void BaseFilterWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
 
 }
 
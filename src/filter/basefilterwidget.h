@@ -31,8 +31,8 @@ class BaseFilterWidget : public AbstractFilterWidget {
 public:
     BaseFilterWidget(QWidget *parent = 0);
     ~BaseFilterWidget();
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     // true if preview is active
     bool preview();
     void enableFilter(bool enable);
@@ -30,8 +30,6 @@ public:
     QString getName();
     QMap<QString, QVariant> getSettings();
     void setSettings(QMap <QString, QVariant> settings);
-    void settings2Dom(QDomDocument &doc, QDomElement &parent, QMap<QString, QVariant> settings);
-    QMap<QString, QVariant> dom2Settings(QDomElement &filterElement);
 
 
 protected:
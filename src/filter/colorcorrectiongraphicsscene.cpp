@@ -37,7 +37,8 @@ QGraphicsPixmapItem *ColorCorrectionGraphicsScene::pixmapItem()
 
 void ColorCorrectionGraphicsScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
-    QPoint position = event->scenePos().toPoint();
+    // The pixmap item may be scaled (proxy image): use its own coordinates
+    QPoint position = privPixmapItem->mapFromScene(event->scenePos()).toPoint();
 
     QImage image = privPixmapItem->pixmap().toImage();
     if (image.valid(position)) { // The click was isued on the image
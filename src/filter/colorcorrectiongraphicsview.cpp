@@ -20,6 +20,7 @@
 #include <QImage>
 #include <QDebug>
 #include <QWheelEvent>
+#include "stagelog.h"
 
 
 ColorCorrectionGraphicsView::ColorCorrectionGraphicsView(QWidget *parent) :
@@ -50,16 +51,28 @@ ColorCorrectionGraphicsView::wheelEvent(QWheelEvent *event)
         int numSteps = numDegrees / 15;
         double factor = pow(1.125, numSteps);
         scale(factor, factor);
+        if (proxyScale < 1 && transform().m11() * devicePixelRatioF() > proxyScale)
+            emit proxyResolutionExceeded();
     } else {
         QGraphicsView::wheelEvent(event);
     }
 }
 
 // Must reimplement as scene is another Class.
-void ColorCorrectionGraphicsView::setPixmap(const QPixmap pixmap)
+void ColorCorrectionGraphicsView::setImage(const QImage image, qreal proxyScale)
 {
-    scene->setSceneRect(pixmap.rect());
+    QString page = StageLog::globalInstance()->currentPage();
+    QPixmap pixmap;
+    {
+        StageTimer timer("Pixmap", page);
+        pixmap = QPixmap::fromImage(image);
+    }
+
+    StageTimer timer("View", page);
+    this->proxyScale = proxyScale;
+    scene->setSceneRect(0, 0, image.width() / proxyScale, image.height() / proxyScale);
     pixmapItem->setPixmap(pixmap);
+    pixmapItem->setScale(1 / proxyScale);
 
     /* Zoom the QGraphicsView to fit the new Pixmap */
     fitInView(pixmapItem, Qt::KeepAspectRatio);
@@ -29,17 +29,19 @@ class ColorCorrectionGraphicsView : public QGraphicsView
 public:
     ColorCorrectionGraphicsView(QWidget *parent = 0);
     ~ColorCorrectionGraphicsView();
-    void setPixmap(const QPixmap pixmap);
+    void setImage(const QImage image, qreal proxyScale = 1.0);
 
 public slots:
     void colorFromScene(QColor color);
 signals:
     void pixmapClicked(QColor color);
+    void proxyResolutionExceeded();
 protected:
     void wheelEvent(QWheelEvent *event);
 //    QGraphicsScene *scene = NULL;
     ColorCorrectionGraphicsScene *scene = NULL;
     QGraphicsPixmapItem *pixmapItem = NULL;
+    qreal proxyScale = 1.0;
 };
 
 #endif // COLORCORRECTIONGRAPHICSVIEW_H
@@ -27,6 +27,8 @@ ColorCorrectionWidget::ColorCorrectionWidget(QWidget *parent) :
     ui(new Ui::ColorCorrectionWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
 
     connect(ui->view, SIGNAL(pixmapClicked(QColor)),
             this, SLOT(imageClicked(QColor)));
@@ -39,19 +41,19 @@ ColorCorrectionWidget::~ColorCorrectionWidget()
 }
 
 
-void ColorCorrectionWidget::setPixmap(QPixmap pixmap)
+void ColorCorrectionWidget::setImage(QImage image)
 {
-    inputPixmap = pixmap;
+    inputImage = image;
     if (!preview()) {
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
     }
 }
 
-void ColorCorrectionWidget::setPreview(QPixmap pixmap)
+void ColorCorrectionWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
     if (preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
 bool ColorCorrectionWidget::preview()
@@ -109,7 +111,7 @@ void ColorCorrectionWidget::on_preview_toggled(bool checked)
         // This does recalculate the output image if necessary and sets the preview Image.
         emit previewChecked();
     } else {
-        ui->view->setPixmap(inputPixmap);
+        ui->view->setImage(inputImage, proxyScale);
     }
 }
 
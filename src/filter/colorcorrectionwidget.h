@@ -36,8 +36,8 @@ class ColorCorrectionWidget : public AbstractFilterWidget
 public:
     explicit ColorCorrectionWidget(QWidget *parent = 0);
     ~ColorCorrectionWidget();
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     bool preview();
     QColor whitePoint();
     QColor blackPoint();
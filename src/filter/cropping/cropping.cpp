@@ -17,6 +17,7 @@
  * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "cropping.h"
+#include "filterengine.h"
 
 Cropping::Cropping(QObject *parent)
 {
@@ -38,17 +39,15 @@ Cropping::Cropping(QObject *parent)
             this, SLOT(enableFilterToggled(bool)));
     connect(widget, SIGNAL(previewChecked()),
             this, SLOT(previewChecked()));
+    connect(widget, SIGNAL(dragStarted()),
+            this, SLOT(dragStarted()));
+    connect(widget, SIGNAL(dragFinished()),
+            this, SLOT(dragFinished()));
 }
 
 QImage Cropping::filter(QImage inputImage)
 {
-    if (filterEnabled) {
-        QRect rectangle = widget->rectangle();
-
-        return inputImage.copy(rectangle);
-    } else {
-        return inputImage;
-    }
+    return FilterEngine::crop(inputImage, CroppingParameters::fromSettings(getSettings()).scaled(proxyScale));
 }
 
 /** \brief Returns a universal name for this filter.
@@ -95,62 +94,5 @@ void Cropping::setSettings(QMap<QString, QVariant> settings)
     emit parameterChanged();
 }
 
-void Cropping::settings2Dom(QDomDocument &doc, QDomElement &imageElement, QMap<QString, QVariant> settings)
-{
-    QDomElement filter = doc.createElement(getIdentifier());
-    imageElement.appendChild(filter);
-
-    QDomElement pointElement;
-    QPointF point;
-
-    QString corner;
-    QStringList cornerNames;
-    int i;
-
-    // Iterate through cornerNames to save all Positions
-    cornerNames << "bottomRightCorner" << "topLeftCorner";
-    for (i = 0; i < cornerNames.size(); i++) {
-        corner = cornerNames.at(i);
-        if (settings.contains(corner)) {
-            pointElement = doc.createElement(corner);
-            point = settings[corner].toPoint();
-            pointElement.setAttribute("x", point.x());
-            pointElement.setAttribute("y", point.y());
-            filter.appendChild(pointElement);
-        }
-    }
-
-    if (settings.contains("enabled"))
-        filter.setAttribute("enabled", settings["enabled"].toBool());
-    else
-        filter.setAttribute("enabled", true);
-}
-
-QMap<QString, QVariant> Cropping::dom2Settings(QDomElement &filterElement)
-{
-    QMap<QString, QVariant> settings;
-    QStringList cornerNames;
-    QString corner;
-    int i;
-    QDomElement cornerElement;
-
-    // Iterate through cornerNames to save all Positions
-    cornerNames << "bottomRightCorner" << "topLeftCorner";
-
-    for (i = 0; i < cornerNames.size(); i++) {
-        corner = cornerNames.at(i);
-
-        cornerElement = filterElement.firstChildElement(corner);
-
-        if (!cornerElement.isNull()) {
-            settings[corner] = QPointF(cornerElement.attribute("x").toDouble(),
-                                       cornerElement.attribute("y").toDouble());
-        }
-    }
-    settings["enabled"] = filterElement.attribute("enabled", "1").toInt();
-
-    return settings;
-}
-
 
 
@@ -6,6 +6,12 @@ CroppingWidget::CroppingWidget(QWidget *parent) :
     ui(new Ui::CroppingWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
+    connect(ui->view, SIGNAL(dragStarted()),
+            this, SIGNAL(dragStarted()));
+    connect(ui->view, SIGNAL(dragFinished()),
+            this, SIGNAL(dragFinished()));
 
     connect(ui->view, SIGNAL(parameterChanged()),
             this, SLOT(gvParameterChanged()));
@@ -23,22 +29,22 @@ void CroppingWidget::on_preview_toggled(bool checked)
         // This does recalculate the output image if necessary and sets the preview Image.
         emit previewChecked();
     } else {
-        ui->view->setPixmap(inputPixmap);
+        ui->view->setImage(inputImage, proxyScale);
     }
 }
 
-void CroppingWidget::setPixmap(QPixmap pixmap)
+void CroppingWidget::setImage(QImage image)
 {
-    inputPixmap = pixmap;
+    inputImage = image;
     if (!preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
-void CroppingWidget::setPreview(QPixmap pixmap)
+void CroppingWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
     if (preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
 bool CroppingWidget::preview()
@@ -14,8 +14,8 @@ class CroppingWidget : public AbstractFilterWidget
 public:
     explicit CroppingWidget(QWidget *parent = 0);
     ~CroppingWidget();
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     bool preview();
     QRect rectangle();
     bool rectangleMoved();
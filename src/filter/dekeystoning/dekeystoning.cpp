@@ -17,6 +17,7 @@
  * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "dekeystoning.h"
+#include "filterengine.h"
 #include <QDebug>
 #include <QColor>
 
@@ -41,6 +42,10 @@ Dekeystoning::Dekeystoning(QObject *parent)
             this, SLOT(enableFilterToggled(bool)));
     connect(widget, SIGNAL(previewChecked()),
             this, SLOT(previewChecked()));
+    connect(widget, SIGNAL(dragStarted()),
+            this, SLOT(dragStarted()));
+    connect(widget, SIGNAL(dragFinished()),
+            this, SLOT(dragFinished()));
 
 }
 
@@ -88,87 +93,8 @@ void Dekeystoning::setSettings(QMap<QString, QVariant> settings)
     emit parameterChanged();
 }
 
-void Dekeystoning::settings2Dom(QDomDocument &doc, QDomElement &imageElement, QMap<QString, QVariant> settings)
-{
-    QDomElement filter = doc.createElement(getIdentifier());
-    imageElement.appendChild(filter);
-
-    QDomElement pointElement;
-    QPointF point;
-
-    QString corner;
-    QStringList cornerNames;
-    int i;
-
-    // Iterate through cornerNames to save all 4 Positions
-    cornerNames << "topLeftCorner" << "topRightCorner" << "bottomRightCorner" << "bottomLeftCorner";
-    for (i = 0; i < cornerNames.size(); i++) {
-        corner = cornerNames.at(i);
-        if (settings.contains(corner)) {
-            pointElement = doc.createElement(corner);
-            point = settings[corner].toPoint();
-            pointElement.setAttribute("x", point.x());
-            pointElement.setAttribute("y", point.y());
-            filter.appendChild(pointElement);
-        }
-    }
-    if (settings.contains("enabled"))
-        filter.setAttribute("enabled", settings["enabled"].toBool());
-    else
-        filter.setAttribute("enabled", true);
-}
-
-QMap<QString, QVariant> Dekeystoning::dom2Settings(QDomElement &filterElement)
-{
-    QMap<QString, QVariant> settings;
-    QStringList cornerNames;
-    QString corner;
-    int i;
-    QDomElement cornerElement;
-
-    // Iterate through cornerNames to save all 4 Positions
-    cornerNames << "topLeftCorner" << "topRightCorner" << "bottomRightCorner" << "bottomLeftCorner";
-
-
-    for (i = 0; i < cornerNames.size(); i++) {
-        corner = cornerNames.at(i);
-
-        cornerElement = filterElement.firstChildElement(corner);
-
-        if (!cornerElement.isNull()) {
-            settings[corner] = QPointF(cornerElement.attribute("x").toDouble(),
-                                       cornerElement.attribute("y").toDouble());
-        }
-    }
-
-    settings["enabled"] = filterElement.attribute("enabled", "1").toInt();
-    return settings;
-}
-
 QImage Dekeystoning::filter(QImage inputImage)
 {
-    if (!filterEnabled)
-        return inputImage;
-
-    QPolygonF polygon = widget->polygon();
-
-    QTransform transformMatrix;
-    /* it might not be possbible to calculate a treansformation matrix */
-    if (!QTransform::quadToSquare(polygon, transformMatrix)) {
-        qDebug() << "No transformation exists for this";
-        return QImage();
-    }
-
-    /* As transformMatrix transforms the polygon to a unit square (1px * 1px), we have
-     * to scale it back to the size of our rectangle selection. We use the mean size of
-     * the Rectangle as a reference. */
-    qreal width  = widget->meanWidth();
-    qreal height = widget->meanHeight();
-    QTransform scaleMatrix = QTransform::fromScale(width, height);
-
-    QTransform transformationMatrix = transformMatrix * scaleMatrix;
-
-    return inputImage.transformed(transformationMatrix);
-
+    return FilterEngine::dekeystone(inputImage, DekeystoningParameters::fromSettings(getSettings()).scaled(proxyScale));
 }
 
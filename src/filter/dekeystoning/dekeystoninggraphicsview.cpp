@@ -22,7 +22,7 @@
     \brief Display a polygon over an image for configuring of deykeystoning.
 
     DekeystoningGraphicsView inherits BaseFilterGraphicsView and its
-    features (scene, zooming, setPixmap).
+    features (scene, zooming, setImage).
     The polygon can be hidden (to display the preview of the pixmap.
  */
 
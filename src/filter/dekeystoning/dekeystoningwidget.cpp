@@ -24,6 +24,12 @@ DekeystoningWidget::DekeystoningWidget(QWidget *parent) :
     ui(new Ui::DekeystoningWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
+    connect(ui->view, SIGNAL(dragStarted()),
+            this, SIGNAL(dragStarted()));
+    connect(ui->view, SIGNAL(dragFinished()),
+            this, SIGNAL(dragFinished()));
 
     connect(ui->view, SIGNAL(parameterChanged()),
             this, SLOT(gvParameterChanged()));
@@ -46,18 +52,18 @@ void DekeystoningWidget::changeEvent(QEvent *e)
     }
 }
 
-void DekeystoningWidget::setPixmap(QPixmap pixmap)
+void DekeystoningWidget::setImage(QImage image)
 {
-    inputPixmap = pixmap;
+    inputImage = image;
     if (!preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
-void DekeystoningWidget::setPreview(QPixmap pixmap)
+void DekeystoningWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
     if (preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
 qreal DekeystoningWidget::meanWidth()
@@ -87,7 +93,7 @@ void DekeystoningWidget::on_preview_toggled(bool checked)
         // This does recalculate the output image if necessary and sets the preview Image.
         emit previewChecked();
     } else {
-        ui->view->setPixmap(inputPixmap);
+        ui->view->setImage(inputImage, proxyScale);
     }
 }
 
@@ -31,8 +31,8 @@ class DekeystoningWidget : public AbstractFilterWidget {
 public:
     DekeystoningWidget(QWidget *parent = 0);
     ~DekeystoningWidget();
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     bool preview();
     qreal meanWidth();
     qreal meanHeight();
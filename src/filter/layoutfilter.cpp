@@ -19,9 +19,9 @@
 
 #include "layoutfilter.h"
 #include "constants.h"
+#include "filterengine.h"
 
 #include <QDebug>
-#include <QPainter>
 
 LayoutFilter::LayoutFilter(QObject * parent) : BaseFilter(parent)
 {
@@ -94,75 +94,6 @@ void LayoutFilter::setSettings(QMap<QString, QVariant> settings)
     emit parameterChanged();
 }
 
-void LayoutFilter::settings2Dom(QDomDocument &doc, QDomElement &parent, QMap<QString, QVariant> settings)
-{
-    QDomElement filter = doc.createElement(getIdentifier());
-    parent.appendChild(filter);
-
-    QString attribute;
-    QStringList attributeNames;
-    int i;
-
-    // Iterate through attributeNames to save all double
-    attributeNames << "pxPageWidth" << "pxPageHeight";
-
-    for (i = 0; i < attributeNames.size(); i++) {
-        attribute = attributeNames.at(i);
-        if (settings.contains(attribute)) {
-            filter.setAttribute(attribute, Constants::float2String(settings[attribute].toDouble()));
-        }
-    }
-
-    // Iterate through attributeNames to save all strings
-    attributeNames.clear();
-    attributeNames << "horizontalAlignement" << "verticalAlignement";
-
-    for (i = 0; i < attributeNames.size(); i++) {
-        attribute = attributeNames.at(i);
-        if (settings.contains(attribute)) {
-            filter.setAttribute(attribute, settings[attribute].toString());
-        }
-    }
-
-    if (settings.contains("enabled"))
-        filter.setAttribute("enabled", settings["enabled"].toBool());
-    else
-        filter.setAttribute("enabled", true);
-}
-
-QMap<QString, QVariant> LayoutFilter::dom2Settings(QDomElement &filterElement)
-{
-    QMap<QString, QVariant> settings;
-    QString attribute;
-    QStringList attributeNames;
-    int i;
-    QDomElement cornerElement;
-
-    // Iterate through attributeNames to save all double
-    attributeNames << "pxPageWidth" << "pxPageHeight";
-
-    for (i = 0; i < attributeNames.size(); i++) {
-        attribute = attributeNames.at(i);
-        if (filterElement.hasAttribute(attribute)) {
-            settings[attribute] = filterElement.attribute(attribute).toDouble();
-        }
-    }
-
-    // Iterate through attributeNames to save all strings
-    attributeNames << "horizontalAlignement" << "verticalAlignement";
-
-    for (i = 0; i < attributeNames.size(); i++) {
-        attribute = attributeNames.at(i);
-        if (filterElement.hasAttribute(attribute)) {
-            settings[attribute] = filterElement.attribute(attribute);
-        }
-    }
-
-    settings["enabled"] = filterElement.attribute("enabled", "1").toInt();
-
-    return settings;
-}
-
 void LayoutFilter::setDisplayUnit(QString unit)
 {
     widget->setDisplayUnit(unit);
@@ -170,52 +101,5 @@ void LayoutFilter::setDisplayUnit(QString unit)
 
 QImage LayoutFilter::filter(QImage inputImage)
 {
-    if (!filterEnabled)
-        return inputImage;
-
-    qreal pageWidth = widget->pagePixelWidth();
-    qreal pageHeight = widget->pagePixelHeight();
-
-    if (pageWidth == 0 || pageHeight == 0 || inputPixmap.isNull()) {
-        return QImage();
-    }
-
-    qreal imageWidth = inputImage.width();
-    qreal imageHeight = inputImage.height();
-
-    qreal leftMargin = 0;
-    qreal topMargin = 0;
-    QString horizontalAlignement = widget->horizontalAlignement();
-    QString verticalAlignement = widget->verticalAlignement();
-
-    // indexOf returns -1 if the alignement is unknown. In this case, margin = 0;
-    switch (Constants::horizontalAlignment.indexOf(horizontalAlignement)) {
-    case Constants::LeftHAlignment:
-        leftMargin = 0;
-        break;
-    case Constants::CenterHAlignment:
-        leftMargin = qMax((pageWidth - imageWidth) / 2, 0.0);
-        break;
-    case Constants::RightHAlignment:
-        leftMargin = qMax(pageWidth - imageWidth, 0.0);
-        break;
-    }
-    switch (Constants::verticalAlignment.indexOf(verticalAlignement)) {
-    case Constants::TopVAlignment:
-        topMargin = 0;
-        break;
-    case Constants::CenterVAlignment:
-        topMargin = qMax((pageHeight - imageHeight) / 2, 0.0);
-        break;
-    case Constants::BottomVAlignment:
-        topMargin = qMax(pageHeight - imageHeight, 0.0);
-        break;
-    }
-
-    QImage page = QImage(pageWidth, pageHeight, QImage::Format_ARGB32_Premultiplied);
-    //NOTE: fill color could be a parameter. I do wait for user feedback ;-)
-    page.fill(Qt::white);
-    QPainter painter(&page);
-    painter.drawImage(leftMargin, topMargin, inputImage);
-    return page;
+    return FilterEngine::layout(inputImage, LayoutParameters::fromSettings(getSettings()).scaled(proxyScale));
 }
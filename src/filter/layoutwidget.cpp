@@ -31,6 +31,8 @@ LayoutWidget::LayoutWidget(QWidget *parent) :
     ui(new Ui::LayoutWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
 
 
     // default value
@@ -57,26 +59,26 @@ LayoutWidget::~LayoutWidget()
     delete doubleValidator;
 }
 
-void LayoutWidget::setPixmap(QPixmap pixmap)
+void LayoutWidget::setImage(QImage image)
 {
-    inputPixmap = pixmap;
-    if (!pixmap.isNull()
+    inputImage = image;
+    if (!image.isNull()
             && pxPageWidth == 0
             && pxPageHeight == 0) {
-        pxPageWidth = pixmap.width();
-        pxPageHeight = pixmap.height();
+        pxPageWidth = fullResolutionSize(image).width();
+        pxPageHeight = fullResolutionSize(image).height();
     }
     updateFormSizes();
     if (!preview()) {
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
     }
 }
 
-void LayoutWidget::setPreview(QPixmap pixmap)
+void LayoutWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
     if (preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
 bool LayoutWidget::preview()
@@ -180,7 +182,7 @@ void LayoutWidget::on_preview_toggled(bool checked)
         // This does recalculate the output image if necessary and sets the preview Image.
         emit previewChecked();
     } else
-        ui->view->setPixmap(inputPixmap);
+        ui->view->setImage(inputImage, proxyScale);
 }
 
 // When a parameter is changed, the input and resulting Image Sizes are recalculated with this function.
@@ -201,8 +203,9 @@ void LayoutWidget::updateFormSizes()
     ui->millimeterPageHeight->setText(
                 Constants::float2String(pxPageHeight / dpi * Constants::milimeterPerInch));
 
-    int inputWidth = inputPixmap.width();
-    int inputHeight = inputPixmap.height();
+    QSize inputSize = fullResolutionSize(inputImage);
+    int inputWidth = inputSize.width();
+    int inputHeight = inputSize.height();
     ui->pixelInputWidth->setText(Constants::float2String(inputWidth));
     ui->pixelInputHeight->setText(Constants::float2String(inputHeight));
     ui->inchInputWidth->setText(Constants::float2String(inputWidth / dpi));
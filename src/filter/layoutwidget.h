@@ -37,8 +37,8 @@ public:
     explicit LayoutWidget(QWidget *parent = 0);
     ~LayoutWidget();
     
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     bool preview();
     double pagePixelHeight();
     double pagePixelWidth();
@@ -17,6 +17,7 @@
  * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "rotation.h"
+#include "filterengine.h"
 #include <QDebug>
 
 Rotation::Rotation(QObject * parent) : BaseFilter(parent)
@@ -57,13 +58,7 @@ QString Rotation::getName()
 
 QImage Rotation::filter(QImage inputImage)
 {
-    if (filterEnabled) {
-        rotationMatrix.reset();
-        rotationMatrix.rotate(widget->rotation());
-        return inputImage.transformed(rotationMatrix);
-    } else {
-        return inputImage;
-    }
+    return FilterEngine::rotate(inputImage, RotationParameters::fromSettings(getSettings()));
 }
 
 // Return the settings of the filter: Rotation Angle in Degrees and Enable Checkbox
@@ -101,28 +96,3 @@ void Rotation::setSettings(QMap<QString, QVariant> settings)
     emit parameterChanged();
 }
 
-void Rotation::settings2Dom(QDomDocument &doc, QDomElement &parent, QMap<QString, QVariant> settings)
-{
-    QDomElement filter = doc.createElement(getIdentifier());
-    parent.appendChild(filter);
-    if (settings.contains("rotation"))
-        filter.setAttribute("angle", settings["rotation"].toInt());
-    else
-        filter.setAttribute("angle", 0);
-
-    if (settings.contains("enabled"))
-        filter.setAttribute("enabled", settings["enabled"].toBool());
-    else
-        filter.setAttribute("enabled", true);
-}
-
-QMap<QString, QVariant> Rotation::dom2Settings(QDomElement &filterElement)
-{
-    QMap<QString, QVariant> settings;
-
-    settings["rotation"] = filterElement.attribute("angle", "0").toInt();
-    settings["enabled"] = filterElement.attribute("enabled", "1").toInt();
-
-    return settings;
-}
-
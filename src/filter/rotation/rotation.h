@@ -33,8 +33,6 @@ public:
     QString getName();
     QMap<QString, QVariant> getSettings();
     void setSettings(QMap <QString, QVariant> settings);
-    void settings2Dom(QDomDocument &doc, QDomElement &parent, QMap<QString, QVariant> settings);
-    QMap<QString, QVariant> dom2Settings(QDomElement &filterElement);
 
 protected:
     virtual QImage filter(QImage inputImage);
@@ -42,7 +40,6 @@ protected:
 
 private:
     RotationWidget *widget;
-    QTransform rotationMatrix;
 };
 
 #endif // ROTATION_H
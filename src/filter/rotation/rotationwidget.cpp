@@ -25,6 +25,8 @@ RotationWidget::RotationWidget(QWidget *parent) :
     ui(new Ui::RotationWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
     rotationAngle = 0;
 }
 
@@ -33,19 +35,19 @@ RotationWidget::~RotationWidget()
     delete ui;
 }
 
-void RotationWidget::setPixmap(QPixmap pixmap)
+void RotationWidget::setImage(QImage image)
 {
-    inputPixmap = pixmap;
+    inputImage = image;
     if (!preview()) {
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
     }
 }
 
-void RotationWidget::setPreview(QPixmap pixmap)
+void RotationWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
     if (preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
 
@@ -68,7 +70,7 @@ void RotationWidget::on_preview_toggled(bool checked)
         // This does recalculate the output image if necessary and sets the preview Image.
         emit previewChecked();
     } else {
-        ui->view->setPixmap(inputPixmap);
+        ui->view->setImage(inputImage, proxyScale);
     }
 }
 
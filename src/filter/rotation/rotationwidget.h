@@ -33,8 +33,8 @@ class RotationWidget : public AbstractFilterWidget
 public:
     explicit RotationWidget(QWidget *parent = 0);
     ~RotationWidget();
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     bool preview();
     int rotation();
     void setRotation(int degrees);
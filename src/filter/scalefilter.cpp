@@ -19,8 +19,7 @@
 
 #include "scalefilter.h"
 #include "constants.h"
-
-#include <QPainter>
+#include "filterengine.h"
 
 ScaleFilter::ScaleFilter(QObject * parent) : BaseFilter(parent)
 {
@@ -93,54 +92,6 @@ void ScaleFilter::setSettings(QMap<QString, QVariant> settings)
     emit parameterChanged();
 }
 
-void ScaleFilter::settings2Dom(QDomDocument &doc, QDomElement &parent, QMap<QString, QVariant> settings)
-{
-    QDomElement filter = doc.createElement(getIdentifier());
-    parent.appendChild(filter);
-
-    QString attribute;
-    QStringList attributeNames;
-    int i;
-
-    // Iterate through attributeNames to save all double
-    attributeNames << "pxImageWidth" << "pxImageHeight";
-
-    for (i = 0; i < attributeNames.size(); i++) {
-        attribute = attributeNames.at(i);
-        if (settings.contains(attribute)) {
-            filter.setAttribute(attribute, Constants::float2String(settings[attribute].toDouble()));
-        }
-    }
-
-    if (settings.contains("enabled"))
-        filter.setAttribute("enabled", settings["enabled"].toBool());
-    else
-        filter.setAttribute("enabled", true);
-}
-
-QMap<QString, QVariant> ScaleFilter::dom2Settings(QDomElement &filterElement)
-{
-    QMap<QString, QVariant> settings;
-    QString attribute;
-    QStringList attributeNames;
-    int i;
-    QDomElement cornerElement;
-
-    // Iterate through attributeNames to save all double
-    attributeNames << "pxImageWidth" << "pxImageHeight";
-
-    for (i = 0; i < attributeNames.size(); i++) {
-        attribute = attributeNames.at(i);
-        if (filterElement.hasAttribute(attribute)) {
-            settings[attribute] = filterElement.attribute(attribute).toDouble();
-        }
-    }
-
-    settings["enabled"] = filterElement.attribute("enabled", "1").toInt();
-
-    return settings;
-}
-
 void ScaleFilter::setDisplayUnit(QString unit)
 {
     displayUnit = unit;
@@ -149,17 +100,5 @@ void ScaleFilter::setDisplayUnit(QString unit)
 
 QImage ScaleFilter::filter(QImage inputImage)
 {
-    if (!filterEnabled)
-        return inputImage;
-
-    qreal imageWidth = widget->imagePixelWidth();
-    qreal imageHeight = widget->imagePixelHeight();
-
-    if (imageWidth == 0 || imageHeight == 0 || inputPixmap.isNull()) {
-        return QImage();
-    }
-
-    QSize outputImageSize = QSize(imageWidth, imageHeight);
-    QImage scaledImage = inputImage.scaled(outputImageSize);
-    return scaledImage;
+    return FilterEngine::scale(inputImage, ScaleParameters::fromSettings(getSettings()).scaled(proxyScale));
 }
@@ -30,6 +30,8 @@ ScaleWidget::ScaleWidget(QWidget *parent) :
     ui(new Ui::ScaleWidget)
 {
     ui->setupUi(this);
+    connect(ui->view, SIGNAL(proxyResolutionExceeded()),
+            this, SIGNAL(fullResolutionRequested()));
 
 
     // default value
@@ -42,6 +44,9 @@ ScaleWidget::ScaleWidget(QWidget *parent) :
     ui->imageHeight->setValidator(doubleValidator);
     ui->imageWidth->setValidator(doubleValidator);
 
+    ui->quality->insertItems(0, Constants::scaleQuality);
+    ui->quality->setCurrentIndex(Constants::scaleQuality.indexOf("Smooth"));
+
     setDPI(Constants::DEFAULT_DPI);
 }
 
@@ -51,26 +56,26 @@ ScaleWidget::~ScaleWidget()
     delete doubleValidator;
 }
 
-void ScaleWidget::setPixmap(QPixmap pixmap)
+void ScaleWidget::setImage(QImage image)
 {
-    inputPixmap = pixmap;
-    if (!pixmap.isNull()
+    inputImage = image;
+    if (!image.isNull()
             && pxImageWidth == 0
             && pxImageHeight == 0) {
-        pxImageWidth = pixmap.width();
-        pxImageHeight = pixmap.height();
+        pxImageWidth = fullResolutionSize(image).width();
+        pxImageHeight = fullResolutionSize(image).height();
     }
     updateFormSizes();
     if (!preview()) {
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
     }
 }
 
-void ScaleWidget::setPreview(QPixmap pixmap)
+void ScaleWidget::setPreview(QImage image)
 {
-    previewPixmap = pixmap;
+    previewImage = image;
     if (preview())
-        ui->view->setPixmap(pixmap);
+        ui->view->setImage(image, proxyScale);
 }
 
 bool ScaleWidget::preview()
@@ -88,12 +93,18 @@ double ScaleWidget::imagePixelWidth()
     return pxImageWidth;
 }
 
+QString ScaleWidget::quality()
+{
+    return ui->quality->currentText();
+}
+
 QMap<QString, QVariant> ScaleWidget::getSettings()
 {
     QMap<QString, QVariant> settings;
 
     settings["pxImageWidth"] = pxImageWidth;
     settings["pxImageHeight"] = pxImageHeight;
+    settings["quality"] = quality();
     return settings;
 }
 
@@ -101,6 +112,12 @@ void ScaleWidget::setSettings(QMap<QString, QVariant> settings)
 {
     pxImageWidth = settings["pxImageWidth"].toDouble();
     pxImageHeight = settings["pxImageHeight"].toDouble();
+    if (Constants::scaleQuality.contains(settings["quality"].toString())) {
+        ui->quality->setCurrentIndex(
+                    Constants::scaleQuality.indexOf(settings["quality"].toString()));
+    } else {
+        ui->quality->setCurrentIndex(Constants::scaleQuality.indexOf("Smooth"));
+    }
 
     // Update the form
     updateFormSizes();
@@ -145,7 +162,7 @@ void ScaleWidget::on_preview_toggled(bool checked)
         // This does recalculate the output image if necessary and sets the preview Image.
         emit previewChecked();
     } else
-        ui->view->setPixmap(inputPixmap);
+        ui->view->setImage(inputImage, proxyScale);
 }
 
 // When a parameter is changed, the input and resulting image Sizes are recalculated with this function.
@@ -166,8 +183,9 @@ void ScaleWidget::updateFormSizes()
     ui->millimeterImageHeight->setText(
                 Constants::float2String(pxImageHeight / dpi * Constants::milimeterPerInch));
 
-    int inputWidth = inputPixmap.width();
-    int inputHeight = inputPixmap.height();
+    QSize inputSize = fullResolutionSize(inputImage);
+    int inputWidth = inputSize.width();
+    int inputHeight = inputSize.height();
     ui->pixelInputWidth->setText(Constants::float2String(inputWidth));
     ui->pixelInputHeight->setText(Constants::float2String(inputHeight));
     ui->inchInputWidth->setText(Constants::float2String(inputWidth / dpi));
@@ -245,6 +263,13 @@ void ScaleWidget::on_imageHeight_textEdited(const QString &strValue)
         ui->imageHeight->setStyleSheet("");
     }}
 
+// activated() is only emitted by the user, not by setSettings()
+void ScaleWidget::on_quality_activated(int index)
+{
+    Q_UNUSED(index);
+    emit parameterChanged();
+}
+
 void ScaleWidget::on_enable_toggled(bool checked)
 {
     emit enableFilterToggled(checked);
@@ -38,11 +38,12 @@ public:
     explicit ScaleWidget(QWidget *parent = 0);
     ~ScaleWidget();
     
-    void setPixmap(QPixmap pixmap);
-    void setPreview(QPixmap pixmap);
+    void setImage(QImage image);
+    void setPreview(QImage image);
     bool preview();
     double imagePixelHeight();
     double imagePixelWidth();
+    QString quality();
 
     QMap<QString, QVariant> getSettings();
     void setSettings(QMap <QString, QVariant> settings);
@@ -60,6 +61,7 @@ private slots:
     void on_imageHeight_editingFinished();
     void on_imageWidth_textEdited(const QString &strValue);
     void on_imageHeight_textEdited(const QString &strValue);
+    void on_quality_activated(int index);
 
     void on_enable_toggled(bool checked);
 
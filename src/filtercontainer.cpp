@@ -24,8 +24,13 @@
 #include "scalefilter.h"
 #include "colorcorrection.h"
 #include "layoutfilter.h"
+#include "constants.h"
+#include "imagecache.h"
+#include "filterengine.h"
+#include "stagelog.h"
 
-#include <QPrinter>
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QDebug>
 
 /** \class FilterContainer
@@ -78,22 +83,36 @@ FilterContainer::FilterContainer( QWidget * parent)
     connect(scaleFilter, SIGNAL(parameterChanged()),
             layoutFilter, SLOT(inputImageChanged()));
 
-// Deactivation Color Corection for release 0.6: this ist not good enought for a release.
-//    ColorCorrection *colorCorrection = new ColorCorrection(this);
-//    tabToFilter.append(colorCorrection);
-//    addTab(colorCorrection->getWidget(), colorCorrection->getName());
-//    /* connect the filter to previous filter so it gets changes automaticaly */
-//    colorCorrection->setPreviousFilter(layoutFilter);
-//    connect(layoutFilter, SIGNAL(parameterChanged()),
-//            colorCorrection, SLOT(inputImageChanged()));
+    ColorCorrection *colorCorrection = new ColorCorrection(this);
+    tabToFilter.append(colorCorrection);
+    addTab(colorCorrection->getWidget(), colorCorrection->getName());
+    /* connect the filter to previous filter so it gets changes automaticaly */
+    colorCorrection->setPreviousFilter(layoutFilter);
+    connect(layoutFilter, SIGNAL(parameterChanged()),
+            colorCorrection, SLOT(inputImageChanged()));
+
+    recomputePool.setMaxThreadCount(1);
+    BaseFilter *filter;
+    foreach (filter, tabToFilter) {
+        connect(filter->getWidget(), SIGNAL(fullResolutionRequested()),
+                this, SLOT(useFullResolution()));
+        filter->setRecomputePool(&recomputePool);
+    }
 
     // get informed when a tab changed
     connect(this, SIGNAL(currentChanged(int)),
             this, SLOT(tabChanged(int)));
+    proxyPool.setMaxThreadCount(1);
+    connect(&proxyWatcher, SIGNAL(finished()),
+            this, SLOT(proxyLoaded()));
 }
 
 FilterContainer::~FilterContainer()
 {
+    imageGeneration.ref();
+    proxyPool.waitForDone();
+    // The running computation still uses the filters.
+    recomputePool.waitForDone();
     int index;
     for (index = 0; index < tabToFilter.size(); index++) {
         delete tabToFilter[index];
@@ -101,12 +120,138 @@ FilterContainer::~FilterContainer()
     tabToFilter.clear();
 }
 
-/* Sets the image to be worked on. */
-void FilterContainer::setImage(QPixmap pixmap)
+/* Sets the image file to be worked on and its settings, in one transaction.
+
+   The settings are only given to the filters together with the image (see showProxy()), so
+   that the filters never compute the new settings on the previous image, and each filter
+   is computed at most once. The proxy and the outputs of each filter are taken from the
+   ImageCache when the page was already computed with the same settings: the file is then
+   not even decoded. An empty fileName sets an empty page.
+
+   The filters get a proxy of the image, just big enough to fill the view in device pixels.
+   The full resolution is only needed for export (see FilterEngine) or when the user zooms
+   past the resolution of the proxy (see useFullResolution()).
+ */
+void FilterContainer::setPage(QString fileName, QMap<QString, QVariant> settings)
+{
+    pendingSettings = settings;
+    settingsPending = true;
+
+    this->fileName = fileName;
+    StageLog::globalInstance()->setCurrentPage(fileName);
+    sourceKey = fileName.isEmpty() ? QByteArray() : ImageCache::sourceKey(fileName);
+    fullImage = QImage();
+    // Only reads the header of the file
+    fullSize = QImageReader(fileName).size();
+    setFilterImage(proxyScaleFor(fullSize));
+}
+
+/* Switches the current image to full resolution. */
+void FilterContainer::useFullResolution()
+{
+    if (proxyScale >= 1)
+        return;
+    setFilterImage(1.0);
+}
+
+/* Returns the size of the view in device pixels.
+   The filter widgets all have the size of the container, which is a bit larger than the
+   view itself: the proxy is rather too large than too small. */
+QSizeF FilterContainer::viewSize()
+{
+    // Before the window is shown, the widget may not have its final size yet
+    return QSizeF(size().expandedTo(QSize(Constants::MIN_PROXY_SIZE, Constants::MIN_PROXY_SIZE)))
+            * devicePixelRatioF();
+}
+
+/* Returns the factor to reduce an image of imageSize to the size of the view. */
+qreal FilterContainer::proxyScaleFor(QSize imageSize)
+{
+    return FilterEngine::proxyScale(imageSize, viewSize());
+}
+
+/* Gives the filters the image reduced by scale.
+
+   When the proxy is not in the ImageCache, the file is decoded in the background: the
+   filters keep showing the previous image until the new one is ready.
+ */
+void FilterContainer::setFilterImage(qreal scale)
+{
+    QImage image;
+    QMap<QString, QVariant> proxySettings;
+
+    proxyScale = scale;
+    imageGeneration.ref();
+    proxySettings["scale"] = scale;
+    QByteArray key = ImageCache::stageKey(sourceKey, "Proxy", proxySettings);
+
+    if (ImageCache::globalInstance()->find(key, &image)) {
+        showProxy(image, key, scale);
+        return;
+    }
+
+    ProxyJob job;
+    job.fileName = fileName;
+    job.fullImage = fullImage;
+    job.scale = scale;
+    job.key = key;
+    job.generation = imageGeneration.load();
+    proxyWatcher.setFuture(QtConcurrent::run(&proxyPool, &FilterContainer::loadProxy, job, &imageGeneration));
+}
+
+// Runs in a worker thread
+ProxyJob FilterContainer::loadProxy(ProxyJob job, const QAtomicInt *generation)
 {
+    if (generation->load() != job.generation)
+        return job;
+    if (job.fullImage.isNull() && !job.fileName.isEmpty()) {
+        StageTimer timer("Decode", job.fileName);
+        job.fullImage = QImage(job.fileName);
+    }
+    {
+        StageTimer timer("Proxy", job.fileName);
+        job.proxyImage = FilterEngine::proxyImage(job.fullImage, job.scale);
+    }
+    // The full image is not cached: it would take the room of many proxies.
+    if (job.scale < 1)
+        ImageCache::globalInstance()->insert(job.key, job.proxyImage);
+    return job;
+}
+
+void FilterContainer::proxyLoaded()
+{
+    ProxyJob job = proxyWatcher.result();
+
+    // Another image was selected in the meantime.
+    if (job.generation != imageGeneration.load())
+        return;
+
+    fullImage = job.fullImage;
+    showProxy(job.proxyImage, job.key, job.scale);
+}
+
+void FilterContainer::showProxy(QImage image, QByteArray key, qreal scale)
+{
+    BaseFilter *filter;
+
+    if (settingsPending) {
+        // The new image makes all filters recompute anyway: the parameterChanged()
+        // of each filter would only repeat it down the chain.
+        foreach (filter, tabToFilter)
+            filter->blockSignals(true);
+        loadSettings(pendingSettings);
+        foreach (filter, tabToFilter)
+            filter->blockSignals(false);
+        settingsPending = false;
+    }
+
+    foreach (filter, tabToFilter) {
+        filter->setProxyScale(scale);
+    }
+
     // Settings the image on the fist filter results in recalculating the image for all filters,
     // as the each filter emits a parameterChanged signal, which is recieved by the next filter.
-    tabToFilter[0]->setImage(pixmap);
+    tabToFilter[0]->setImage(image, key);
 
     int currentTab = std::min (tabToFilter.size(), currentIndex());
     tabToFilter[currentTab]->refresh();
@@ -150,6 +295,9 @@ QMap<QString, QVariant> FilterContainer::getSettings()
     QMap<QString, QVariant> allSettings;
     BaseFilter *filter;
 
+    // The page is still loading: the filters do not have its settings yet.
+    if (settingsPending)
+        return pendingSettings;
 
     foreach (filter, tabToFilter) {
         allSettings[filter->getIdentifier()] = filter->getSettings();
@@ -163,6 +311,19 @@ QMap<QString, QVariant> FilterContainer::getSettings()
     See also FilterContainer::getSettings
   */
 void FilterContainer::setSettings(QMap<QString, QVariant> settings)
+{
+    if (settingsPending) {
+        pendingSettings = settings;
+        return;
+    }
+    loadSettings(settings);
+
+    int currentTab = std::min (tabToFilter.size(), currentIndex());
+    tabToFilter[currentTab]->refresh();
+}
+
+/* Sets the settings of each filter without computing the image */
+void FilterContainer::loadSettings(QMap<QString, QVariant> settings)
 {
     QString filterName;
     BaseFilter *filter;
@@ -181,50 +342,31 @@ void FilterContainer::setSettings(QMap<QString, QVariant> settings)
             filter->setSettings(QMap<QString, QVariant>());
         }
     }
-
-    int currentTab = std::min (tabToFilter.size(), currentIndex());
-    tabToFilter[currentTab]->refresh();
 }
 
-/* Fills the parent with filter DomEmelents and ther parameters
-   We have to provide the parameters as they are stored in the calling Class (ImageTableWidget)
-   This function is called when serializing the settings into an XML file.
- */
-void FilterContainer::settings2Dom(QDomDocument &doc, QDomElement &imageElement, QMap<QString, QVariant> settings)
-{
-    BaseFilter *filter;
+/** \brief Prepares pages which will probably be displayed next.
 
-    foreach (filter, tabToFilter) {
-        if (settings.contains(filter->getIdentifier())) {
-            filter->settings2Dom(doc, imageElement, settings[filter->getIdentifier()].toMap());
-        }
-    }
-}
-
-// Transforms the subtags from <image> into filter settings QMap.
-// NOTE: It might be interesting to get ride of the QMap and only use DOM for the whole Settings.
-QMap<QString, QVariant> FilterContainer::dom2Settings(QDomElement &imageElement)
+  The filters up to the current tab are computed in the background for each page which
+  already has settings, so that selecting it only needs the ImageCache.
+  See PagePrefetcher.
+ */
+void FilterContainer::prefetch(QList<PrefetchPage> pages)
 {
-    QDomElement filterElement;
-    BaseFilter *filter;
-    QMap<QString, QVariant> settings;
-
-    filterElement = imageElement.firstChildElement();
+    QStringList stages;
+    int index;
 
-    while (!filterElement.isNull()) {
-        foreach (filter, tabToFilter) {
-            if (filterElement.tagName() == filter->getIdentifier()) {
-                settings[filter->getIdentifier()] = filter->dom2Settings(filterElement);
-            }
-        }
-        filterElement = filterElement.nextSiblingElement();
+    for (index = 0; index <= currentIndex() && index < tabToFilter.size(); index++) {
+        stages << tabToFilter[index]->getIdentifier();
     }
-    return settings;
+    prefetcher.prefetch(pages, stages, viewSize());
 }
 
 /** \brief Compute and return the resulting image above all filter
+
+  The image is in the resolution currently used for the preview; use FilterEngine::render()
+  to get the page in full resolution.
  */
-QPixmap FilterContainer::getResultImage()
+QImage FilterContainer::getResultImage()
 {
     int maxTab = tabToFilter.size() - 1;
 
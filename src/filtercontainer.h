@@ -23,10 +23,24 @@
 #include <QMap>
 #include <QVariant>
 #include <QString>
-#include <QtXml/QDomDocument>
 #include "basefilter.h"
 #include "abstractfilterwidget.h"
 #include "scalefilter.h"
+#include "pageprefetcher.h"
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QThreadPool>
+
+/* A proxy image decoded in the background (see FilterContainer::setFilterImage()). */
+struct ProxyJob
+{
+    QString fileName;
+    QImage fullImage;
+    QImage proxyImage;
+    qreal scale = 1.0;
+    QByteArray key;
+    int generation = 0;
+};
 
 class FilterContainer : public QTabWidget
 {
@@ -37,11 +51,10 @@ public:
 
     QMap<QString, QVariant> getSettings();
     void setSettings(QMap<QString, QVariant> settings);
-    void settings2Dom(QDomDocument &doc, QDomElement &imageElement, QMap<QString, QVariant> settings);
-    QMap<QString, QVariant> dom2Settings(QDomElement &imageElement);
-    QPixmap getResultImage();
+    QImage getResultImage();
     QString currentFilter();
-    void setImage(QPixmap pixmap);
+    void setPage(QString fileName, QMap<QString, QVariant> settings);
+    void prefetch(QList<PrefetchPage> pages);
 
 public slots:
     void tabChanged(int index);
@@ -49,9 +62,40 @@ public slots:
     void setBackgroundColor(QColor color);
     void setDisplayUnit(QString unit);
     void setDPI(int dpi);
+    void useFullResolution();
+
+private slots:
+    void proxyLoaded();
 
 private:
+    static ProxyJob loadProxy(ProxyJob job, const QAtomicInt *generation);
+    void showProxy(QImage image, QByteArray key, qreal scale);
+    QSizeF viewSize();
+    qreal proxyScaleFor(QSize imageSize);
+    void setFilterImage(qreal scale);
+    void loadSettings(QMap<QString, QVariant> settings);
     QList<BaseFilter *> tabToFilter;
+    /* The scanned image. The filters work on a copy reduced by proxyScale to the size
+       of the view, the full resolution is only computed on demand. */
+    QImage fullImage;
+    QSize fullSize;
+    qreal proxyScale = 1.0;
+    /* When the image comes from a file, it is only loaded if its proxy is not cached */
+    QString fileName;
+    QByteArray sourceKey;
+    /* Settings of the page being loaded, given to the filters with its image */
+    QMap<QString, QVariant> pendingSettings;
+    bool settingsPending = false;
+    PagePrefetcher prefetcher;
+    /* Incremented for each new image: proxies loaded for an older one are dropped. */
+    QAtomicInt imageGeneration;
+    QFutureWatcher<ProxyJob> proxyWatcher;
+    // one thread: stale images still waiting are skipped instead of decoded
+    QThreadPool proxyPool;
+    /* Worker thread of the filters (see BaseFilter::refresh()). One thread: a new computation
+       waits until the stale one stopped, instead of competing with it (the filters already
+       use all processors). */
+    QThreadPool recomputePool;
     int oldIndex = 0; //stores the last selected index, at init = first tab
 
 signals:
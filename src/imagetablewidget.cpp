@@ -19,8 +19,6 @@
 
 #include <QFileInfo>
 #include <QFileDialog>
-#include <QPrinter>
-#include <QPainter>
 #include <QDebug>
 #include <QProgressDialog>
 
@@ -29,10 +27,12 @@
 
 #include "ui_imagetablewidget.h"
 
-/* FIXME: I am very unhapy with the design of this ImageTableWidget. This is a dirty
-   hack that has to be rewritten. It is a lot of work that noone sees but has to be
-   rewritten before nice features like drag&drop comme in play.
-   Layout has to be separated from Data, items have to become a dedicated widget
+static const int THUMBNAIL_WIDTH = 100;
+// Number of pages prepared in advance in the direction the user is moving
+static const int PREFETCH_PAGES = 2;
+
+/* FIXME: The pages are now stored in a PageModel, but items still have to become a dedicated
+   widget before nice features like drag&drop comme in play
    (ideas: filename under image, display source image or preview, infos with tooltip...)
 */
 
@@ -42,15 +42,16 @@ ImageTableWidget::ImageTableWidget(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    connect(ui->images, SIGNAL(currentItemChanged(QTableWidgetItem*,QTableWidgetItem*)),
-            this, SLOT(currentItemChanged(QTableWidgetItem*,QTableWidgetItem*)));
+    pageModel = new PageModel(this);
+    ui->images->setModel(pageModel);
+    connect(ui->images->selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)),
+            this, SLOT(currentPageChanged(QModelIndex,QModelIndex)));
 
     filterContainer = NULL;
 
-    itemCount[leftSide] = 0;
-    itemCount[rightSide] = 0;
-
-    ui->images->setHorizontalHeaderLabels(QStringList() << "Left" << "Right");
+    thumbnailLoader = new ThumbnailLoader(THUMBNAIL_WIDTH, this);
+    connect(thumbnailLoader, SIGNAL(thumbnailReady(QString,QImage)),
+            this, SLOT(setThumbnail(QString,QImage)));
 }
 
 ImageTableWidget::~ImageTableWidget()
@@ -69,61 +70,111 @@ void ImageTableWidget::setFilterContainer(FilterContainer *container)
 
 
 
-void ImageTableWidget::currentItemChanged(QTableWidgetItem *newItem, QTableWidgetItem *previousItem)
+void ImageTableWidget::currentPageChanged(const QModelIndex &current, const QModelIndex &previous)
 {
-    if (!filterContainer) {
-        // This should never happen, but if so, do nothing.
+    if (!filterContainer || pagesMoving) {
+        // While pages are moved, previous may already show another page.
         return;
     }
 
-    QMap<QString, QVariant> settings;
-    QMap<QString, QVariant> oldSettings;
-    QString filterID = "";
+    // QMap is implicitly shared: storing unchanged settings costs nothing.
+    if (pageModel->hasPage(previous.row(), previous.column()))
+        pageModel->setSettings(previous.row(), previous.column(), filterContainer->getSettings());
 
-    if (previousItem) {
-        settings = filterContainer->getSettings();
-        oldSettings = previousItem->data(ImagePreferences).toMap();
-        // settings changed? Save them!
-        if (settings != oldSettings) {
-            previousItem->setData(ImagePreferences, settings);
-        }
-    }
+    showPage(current, previous);
+}
 
-    if (newItem) {
-        // NOTE: setting the image an setting the settings results in recaluling twice the image
-        // There might be a performance improvement here.
-        filterContainer->setImage(QPixmap(newItem->data(ImageFileName).toString()));
-        filterContainer->setSettings(newItem->data(ImagePreferences).toMap());
+/** \brief Loads the page at current into the filters */
+void ImageTableWidget::showPage(const QModelIndex &current, const QModelIndex &previous)
+{
+    if (!filterContainer)
+        return;
+
+    if (pageModel->hasPage(current.row(), current.column())) {
+        filterContainer->setPage(pageModel->page(current.row(), current.column()).fileName,
+                                 pageModel->settings(current.row(), current.column()));
+        prefetchNeighbours(current, previous);
     } else {
-        // FIXME: can this happen?
-        qDebug() << "ImageTableWidget::currentItemChanged to an empty item";
-        filterContainer->setImage(QPixmap());
-        // Reset Filter Settings as no image is selected
-        filterContainer->setSettings(QMap<QString, QVariant>());
+        // No image and reset filter settings
+        filterContainer->setPage(QString(), QMap<QString, QVariant>());
     }
 }
 
+/** \brief Stores the settings of the filters into the current page */
+void ImageTableWidget::saveCurrentSettings()
+{
+    QModelIndex current = ui->images->currentIndex();
+
+    if (filterContainer && pageModel->hasPage(current.row(), current.column()))
+        pageModel->setSettings(current.row(), current.column(), filterContainer->getSettings());
+}
+
+/** \brief To be called before pages are inserted, moved or removed; see selectMovedPage() */
+void ImageTableWidget::beginMovePages()
+{
+    saveCurrentSettings();
+    pagesMoving = true;
+}
+
+/** \brief Selects the page at row and side once pages have moved, and shows it */
+void ImageTableWidget::selectMovedPage(int row, int side)
+{
+    pagesMoving = true;
+    ui->images->setCurrentIndex(pageModel->index(row, side));
+    pagesMoving = false;
+    showPage(ui->images->currentIndex(), QModelIndex());
+}
+
+/** \brief Prepares the pages the user will probably select after current.
+
+  These are the next pages in the direction of travel (given by previous) and
+  the page on the other side.
+*/
+void ImageTableWidget::prefetchNeighbours(const QModelIndex &current, const QModelIndex &previous)
+{
+    QList<PrefetchPage> pages;
+    QList<int> rows;
+    QList<int> sides;
+    PrefetchPage page;
+    int i;
+
+    int row = current.row();
+    int side = current.column();
+    int direction = 1;
+    if (previous.isValid() && previous.row() > row)
+        direction = -1;
+
+    rows << row + direction << row;
+    sides << side << 1 - side;
+    for (i = 2; i <= PREFETCH_PAGES; i++) {
+        rows << row + i * direction;
+        sides << side;
+    }
+
+    for (i = 0; i < rows.size(); i++) {
+        if (!pageModel->hasPage(rows.at(i), sides.at(i)))
+            continue;
+        page.fileName = pageModel->page(rows.at(i), sides.at(i)).fileName;
+        page.settings = pageModel->settings(rows.at(i), sides.at(i));
+        pages << page;
+    }
+    filterContainer->prefetch(pages);
+}
+
 /** \brief Slot called from the UI to add an one or many images */
 void ImageTableWidget::insertImage()
 {
     QFileInfo fi;
     QString imageFileName;
-    bool moveSelectionDown = false;
     ImageTableWidget::ImageSide side;
+    ProjectPage page;
 
-    int column = ui->images->currentColumn();
-    if (column == 1)
+    QModelIndex current = ui->images->currentIndex();
+    if (current.column() == 1)
         side = ImageTableWidget::rightSide;
     else // defaults to left
         side = ImageTableWidget::leftSide;
 
-    // if there is a selected item, save its settings.
-    QTableWidgetItem *currentImage = ui->images->currentItem();
-    if (currentImage) {
-        // Save current settings: call the currentItemChanged slot newItem = previusItem = currentItem
-        currentItemChanged(currentImage, currentImage);
-    }
-
     if (lastDir.length() == 0)
         lastDir = QDir::currentPath();
 
@@ -144,30 +195,32 @@ void ImageTableWidget::insertImage()
     QProgressDialog progressDialog(tr("Loading images..."), "Abort", 0, numberImages);
     progressDialog.setWindowModality(Qt::WindowModal);
 
+    // Insert the first image before the current one, the others after the previous insertion.
+    int row = pageModel->pageCount(side);
+    if (current.isValid() && current.column() == side)
+        row = qMin(current.row(), row);
+    int firstRow = row;
+
+    beginMovePages();
     foreach (imageFileName, images) {
         // Update Progress Dialog
         progressDialog.setValue(progress);
         progress++;
         if (progressDialog.wasCanceled()) {
             // Allready loaded image can't be undone.
-            // Load settings/image for the current item.
-            currentItemChanged(ui->images->currentItem(), NULL);
-            return;
-        }
-        // Insert the image
-        if (moveSelectionDown) {
-            // Append images after the previous insertion.
-            // Insert the first image depending on current selection, so do nothing.
-            ui->images->setCurrentCell(ui->images->currentRow() + 1, ui->images->currentColumn());
+            break;
         }
-        addImage(imageFileName, side);
-        moveSelectionDown = true;
+        page.fileName = imageFileName;
+        pageModel->insertPage(row, side, page);
+        thumbnailLoader->request(imageFileName);
+        row++;
     }
 
-
-
-    // Load settings/image for the current item.
-    currentItemChanged(ui->images->currentItem(), NULL);
+    // Select the last inserted image
+    if (row > firstRow)
+        selectMovedPage(row - 1, side);
+    else
+        selectMovedPage(current.row(), current.column());
 
     // Close progressDialog
     progressDialog.setValue(numberImages);
@@ -185,96 +238,36 @@ void ImageTableWidget::insertImage()
 */
 void ImageTableWidget::addImage(QString fileName, ImageTableWidget::ImageSide side, QMap<QString, QVariant> settings)
 {
-    QTableWidgetItem *item;
-    QTableWidgetItem *currentItem;
-    QFileInfo fi(fileName);
-    QPixmap icon;
-    int currentRow;
-
-    //NOTE: loading all icons at this time implies waiting time for the user.
-    //Alternatives: put some "waiting" dialog or do ICON-loading in the background
-    icon = QPixmap(fileName).scaledToWidth(100);
-    item = new QTableWidgetItem(QIcon(icon),
-                        fi.fileName());
-    item->setData(ImageFileName, fileName);
-    item->setData(ImagePreferences, settings);
-    item->setToolTip(fileName);
-
-    currentItem = ui->images->currentItem();
-    if (currentItem && ui->images->currentColumn() == side) {
+    ProjectPage page;
+    int row;
+
+    page.fileName = fileName;
+    // The icon is set by setThumbnail() once it is decoded in the background
+    thumbnailLoader->request(fileName);
+
+    QModelIndex current = ui->images->currentIndex();
+    if (current.isValid() && current.column() == side) {
         // Insert before current item
-        currentRow = ui->images->currentRow();
+        row = qMin(current.row(), pageModel->pageCount(side));
     } else {
         // Insert at the End
-        currentRow = itemCount[side];
+        row = pageModel->pageCount(side);
     }
 
-    insertItem(item, currentRow, side);
+    beginMovePages();
+    pageModel->insertPage(row, side, page);
+    if (!settings.isEmpty())
+        pageModel->setSettings(row, side, settings);
 
     // Select the inserted item
-    ui->images->setCurrentItem(item);
-}
-
-/** \brief Inserts an item at row and side */
-void ImageTableWidget::insertItem(QTableWidgetItem *item, int row, int side)
-{
-    int i;
-
-    /* If the position is outside the possible possition, modifiy it to be the best
-     * available value */
-    if (side < 0)
-        side = 0;
-    if (side > 1)
-        side = 1;
-    if (row < 0)
-        row = 0;
-    if (row >= itemCount[side])
-        row = itemCount[side];
-
-    // Adjust Table size if necessary
-    if (itemCount[side] >=  ui->images->rowCount()) {
-        ui->images->setRowCount(itemCount[side] + 1);
-    }
-
-    // move all items after position one step down
-    for (i = itemCount[side]; i > row; i--) {
-        ui->images->setItem(i, side, ui->images->takeItem(i - 1, side));
-    }
-
-    ui->images->setItem(row, side, item);
-    itemCount[side] = itemCount[side] + 1;
-}
-
-/** \brief Appends an image at the end of the Table
-
-*/
-void ImageTableWidget::appendImageToSide(QString fileName,
-                                         ImageTableWidget::ImageSide side,
-                                         QMap<QString, QVariant> settings)
-{
-    QTableWidgetItem *item;
-    QPixmap icon;
-    QFileInfo fi(fileName);
-
-    icon = QPixmap(fileName).scaledToWidth(100);
-    item = new QTableWidgetItem(QIcon(icon),
-                        fi.fileName());
-    // Adjust Table size if necessary
-    if (itemCount[side] >=  ui->images->rowCount()) {
-        ui->images->setRowCount(itemCount[side] + 1);
-    }
-    ui->images->setItem(itemCount[side], side, item);
-    item->setData(ImageFileName, fileName);
-    item->setData(ImagePreferences, settings);
-    item->setToolTip(fileName);
-    itemCount[side] = itemCount[side] + 1;
+    selectMovedPage(row, side);
 }
 
 void ImageTableWidget::insertEmptyImage()
 {
     ImageTableWidget::ImageSide side;
 
-    int column = ui->images->currentColumn();
+    int column = ui->images->currentIndex().column();
     if (column == 1)
         side = ImageTableWidget::rightSide;
     else // defaults to left
@@ -286,80 +279,86 @@ void ImageTableWidget::insertEmptyImage()
 
 void ImageTableWidget::imageDown()
 {
-    int side = ui->images->currentColumn();
-    if (side < 0 || side > 1)
-        return;
+    QModelIndex current = ui->images->currentIndex();
+    int side = current.column();
+    int currentRow = current.row();
 
-    int currentRow = ui->images->currentRow();
-    if (currentRow + 1 > itemCount[side] - 1) {
+    if (!pageModel->hasPage(currentRow, side) || !pageModel->hasPage(currentRow + 1, side)) {
         return;
     }
-    QTableWidgetItem *itemToDown = ui->images->takeItem(currentRow, side);
-    QTableWidgetItem *itemToUp = ui->images->takeItem(currentRow + 1, side);
-    ui->images->setItem(currentRow +1, side, itemToDown);
-    ui->images->setItem(currentRow, side, itemToUp);
-    ui->images->setCurrentItem(itemToDown);
+    beginMovePages();
+    pageModel->swapPages(currentRow, currentRow + 1, side);
+    selectMovedPage(currentRow + 1, side);
 }
 
 void ImageTableWidget::imageUp()
 {
-    int side = ui->images->currentColumn();
-    if (side < 0 || side > 1)
-        return;
+    QModelIndex current = ui->images->currentIndex();
+    int side = current.column();
+    int currentRow = current.row();
 
-    int currentRow = ui->images->currentRow();
-    if (currentRow < 1 || currentRow >= itemCount[side]) {
+    if (!pageModel->hasPage(currentRow, side) || !pageModel->hasPage(currentRow - 1, side)) {
         return;
     }
-    QTableWidgetItem *itemToUp = ui->images->takeItem(currentRow, side);
-    QTableWidgetItem *itemToDown = ui->images->takeItem(currentRow -1, side);
-    ui->images->setItem(currentRow - 1, side, itemToUp);
-    ui->images->setItem(currentRow, side, itemToDown);
-    ui->images->setCurrentItem(itemToUp);
+    beginMovePages();
+    pageModel->swapPages(currentRow, currentRow - 1, side);
+    selectMovedPage(currentRow - 1, side);
 }
 
 void ImageTableWidget::moveImageLeft()
 {
-    int side = ui->images->currentColumn();
+    QModelIndex current = ui->images->currentIndex();
+    int side = current.column();
     if (side != 1) { // nothing to move
         return;
     }
     int otherSide = 1 - side;
 
-    int currentRow = ui->images->currentRow();
-    if (currentRow < 0 || currentRow >= itemCount[side]) {
+    int currentRow = current.row();
+    if (!pageModel->hasPage(currentRow, side)) {
         return;
     }
 
-    QTableWidgetItem *itemToMove = takeItem(currentRow, side);
-    insertItem(itemToMove, currentRow, otherSide);
+    beginMovePages();
+    // The page keeps its settings, whatever the defaults of the other side are
+    QMap<QString, QVariant> settings = pageModel->settings(currentRow, side);
+    ProjectPage page = pageModel->takePage(currentRow, side);
+    currentRow = qMin(currentRow, pageModel->pageCount(otherSide));
+    pageModel->insertPage(currentRow, otherSide, page);
+    pageModel->setSettings(currentRow, otherSide, settings);
     // Select the moved item
-    ui->images->setCurrentItem(itemToMove);
+    selectMovedPage(currentRow, otherSide);
 }
 
 void ImageTableWidget::moveImageRight()
 {
-    int side = ui->images->currentColumn();
+    QModelIndex current = ui->images->currentIndex();
+    int side = current.column();
     if (side != 0) { // nothing to move
         return;
     }
     int otherSide = 1 - side;
 
-    int currentRow = ui->images->currentRow();
-    if (currentRow < 0 || currentRow >= itemCount[side]) {
+    int currentRow = current.row();
+    if (!pageModel->hasPage(currentRow, side)) {
         return;
     }
 
-    QTableWidgetItem *itemToMove = takeItem(currentRow, side);
-    insertItem(itemToMove, currentRow, otherSide);
+    beginMovePages();
+    // The page keeps its settings, whatever the defaults of the other side are
+    QMap<QString, QVariant> settings = pageModel->settings(currentRow, side);
+    ProjectPage page = pageModel->takePage(currentRow, side);
+    currentRow = qMin(currentRow, pageModel->pageCount(otherSide));
+    pageModel->insertPage(currentRow, otherSide, page);
+    pageModel->setSettings(currentRow, otherSide, settings);
     // Select the moved item
-    ui->images->setCurrentItem(itemToMove);
+    selectMovedPage(currentRow, otherSide);
 }
 
 void ImageTableWidget::selectPreviousImage()
 {
-    int side = ui->images->currentColumn();
-    int row = ui->images->currentRow();
+    int side = ui->images->currentIndex().column();
+    int row = ui->images->currentIndex().row();
 
     row = row - 1;
 
@@ -371,16 +370,16 @@ void ImageTableWidget::selectPreviousImage()
         side = 1;
     if (row < 0)
         row = 0;
-    if (row >= itemCount[side])
-        row = itemCount[side] - 1;
+    if (row >= pageModel->pageCount(side))
+        row = pageModel->pageCount(side) - 1;
 
-    ui->images->setCurrentCell(row, side);
+    ui->images->setCurrentIndex(pageModel->index(row, side));
 }
 
 void ImageTableWidget::selectNextImage()
 {
-    int side = ui->images->currentColumn();
-    int row = ui->images->currentRow();
+    int side = ui->images->currentIndex().column();
+    int row = ui->images->currentIndex().row();
 
     row = row + 1;
 
@@ -392,348 +391,232 @@ void ImageTableWidget::selectNextImage()
         side = 1;
     if (row < 0)
         row = 0;
-    if (row >= itemCount[side])
-        row = itemCount[side] - 1;
+    if (row >= pageModel->pageCount(side))
+        row = pageModel->pageCount(side) - 1;
 
-    ui->images->setCurrentCell(row, side);}
+    ui->images->setCurrentIndex(pageModel->index(row, side));
+}
 
 void ImageTableWidget::selectRightImage()
 {
-    int side = ui->images->currentColumn();
-    int row = ui->images->currentRow();
-
-    side = 1;
+    int row = ui->images->currentIndex().row();
+    int side = 1;
 
     /* If the position is outside the possible possition, modifiy it to be the best
      * available value */
     if (row < 0)
         row = 0;
-    if (row >= itemCount[side])
-        row = itemCount[side] - 1;
+    if (row >= pageModel->pageCount(side))
+        row = pageModel->pageCount(side) - 1;
 
-    ui->images->setCurrentCell(row, side);
+    ui->images->setCurrentIndex(pageModel->index(row, side));
 }
 
 void ImageTableWidget::selectLeftImage()
 {
-    int side = ui->images->currentColumn();
-    int row = ui->images->currentRow();
-
-    side = 0;
+    int row = ui->images->currentIndex().row();
+    int side = 0;
 
     /* If the position is outside the possible possition, modifiy it to be the best
      * available value */
     if (row < 0)
         row = 0;
-    if (row >= itemCount[side])
-        row = itemCount[side] - 1;
+    if (row >= pageModel->pageCount(side))
+        row = pageModel->pageCount(side) - 1;
 
-    ui->images->setCurrentCell(row, side);
+    ui->images->setCurrentIndex(pageModel->index(row, side));
 }
 
-QTableWidgetItem * ImageTableWidget::takeItem(int row, int side)
+void ImageTableWidget::removeSelected()
 {
-    int i;
-    QTableWidgetItem *item;
-
-    if (side < 0 || side > 1)
-        return NULL; //Nothing to delete
-    int otherSide = 1 - side;
-
-    if (row >=0 && row >= itemCount[side]) {
-        return NULL; //Nothing to delete
-    }
+    QModelIndex current = ui->images->currentIndex();
+    int currentRow = current.row();
+    int side = current.column();
 
-    item = ui->images->takeItem(row, side);
-    for (i = row; i < itemCount[side] - 1; i++) {
-        ui->images->setItem(i, side,
-                            ui->images->takeItem(i + 1, side));
-    }
-    itemCount[side]--;
-    if (itemCount[side] >= itemCount[otherSide]) {
-        ui->images->setRowCount(itemCount[side]);
-    }
-
-    // if last column removed, scroll one up
-    if (row == itemCount[side] && row > 0) {
-        ui->images->setCurrentCell(row - 1, side);
-    }
+    if (!pageModel->hasPage(currentRow, side))
+        return; //Nothing to delete
 
-    // redraw
-    currentItemChanged(ui->images->currentItem(), NULL);
+    beginMovePages();
+    pageModel->takePage(currentRow, side);
 
-    return item;
+    // if last image removed, select the one above
+    if (currentRow == pageModel->pageCount(side) && currentRow > 0)
+        currentRow--;
+    selectMovedPage(currentRow, side);
 }
 
-
-
-
-void ImageTableWidget::removeSelected()
+/** \brief Gives the pages to project, with only the settings that differ from the defaults */
+void ImageTableWidget::saveProjectParameters(ProjectWriter &project)
 {
-    int currentRow = ui->images->currentRow();
-    int currentColumn = ui->images->currentColumn();
-
-    delete takeItem(currentRow, currentColumn);
-}
+    QList<ExportPage> pages[2];
+    ExportPage page;
+    int side, row;
 
-void ImageTableWidget::saveProjectParameters(QDomDocument &doc, QDomElement &parent)
-{
-    int row;
-    QTableWidgetItem *item;
-    QDomElement imageElement;
-    QMap<QString, QVariant> settings;
-
-    // Save the settings of current filter before saving
-    settings = filterContainer->getSettings();
-    item = ui->images->currentItem();
-    if (item)
-        item->setData(ImagePreferences, settings);
-    settings.clear();
-
-    for (row = 0; row < itemCount[leftSide]; row++) {
-        item = ui->images->item(row, leftSide);
-
-        // Save the image attributes
-        imageElement = doc.createElement("image");
-        imageElement.setAttribute("side", "left");
-        imageElement.setAttribute("filename", item->data(ImageFileName).toString());
-        parent.appendChild(imageElement);
-
-        // Save the filter settings
-        settings = item->data(ImagePreferences).toMap();
-        filterContainer->settings2Dom(doc, imageElement, settings);
+    saveCurrentSettings();
 
+    for (side = leftSide; side <= rightSide; side++) {
+        for (row = 0; row < pageModel->pageCount(side); row++) {
+            page.fileName = pageModel->page(row, side).fileName;
+            page.settings = pageModel->pageOverrides(row, side);
+            pages[side].append(page);
+        }
     }
-    for (row = 0; row < itemCount[rightSide]; row++) {
-        item = ui->images->item(row, rightSide);
-
-        // Save the image attributes
-        imageElement = doc.createElement("image");
-        imageElement.setAttribute("side", "right");
-        imageElement.setAttribute("filename", item->data(ImageFileName).toString());
-        parent.appendChild(imageElement);
-
-        // Save the filter settings
-        settings = item->data(ImagePreferences).toMap();
-        filterContainer->settings2Dom(doc, imageElement, settings);
-    }
-
-
-
-
+    project.setDefaults(pageModel->projectDefaults(), pageModel->sideDefaults(leftSide),
+                        pageModel->sideDefaults(rightSide));
+    project.setPages(pages[leftSide], pages[rightSide]);
 }
 
-// This function loads the parameter from XML (DOM) int yasw
-bool ImageTableWidget::loadProjectParameters(QDomElement &rootElement)
+// This function loads the pages read by project into yasw
+bool ImageTableWidget::loadProjectParameters(ProjectReader &project)
 {
-    QDomElement imageElement;
-    QString sideString;
-    ImageTableWidget::ImageSide side;
-    int progress = 1;
-    QString filename;
-
+    QList<ExportPage> sidePages[2];
+    QList<ProjectPage> pages[2];
+    ExportPage exportPage;
+    ProjectPage page;
+    int side;
 
     clear();
 
-    // Load all Images
-    int numberImages = rootElement.elementsByTagName("image").size();
-
-    QProgressDialog progressDialog("Loading project...", "Abort", 1, numberImages);
-    progressDialog.setWindowModality(Qt::WindowModal);
-
-    QMap<QString, QVariant> settings;
+    sidePages[leftSide] = project.storedPages(leftSide);
+    sidePages[rightSide] = project.storedPages(rightSide);
 
-    imageElement = rootElement.firstChildElement("image");
-    while (!imageElement.isNull()) {
-        // update progress dialog
-        progressDialog.setValue(progress);
-        if (progressDialog.wasCanceled()) {
-            return false;
-        }
-        // load image
-        sideString = imageElement.attribute("side");
-        if (sideString == "left") {
-            side = leftSide;
-        } else if (sideString == "right") {
-            side = rightSide;
-        } else {
-            // Project file is not OK => cancel Loading
-            // FIXME: signal the error to the User?
-            progressDialog.cancel();
-            return false;
+    for (side = leftSide; side <= rightSide; side++) {
+        foreach (exportPage, sidePages[side]) {
+            page.fileName = exportPage.fileName;
+            page.overrides.settings = exportPage.settings;
+            pages[side].append(page);
+            thumbnailLoader->request(page.fileName);
         }
-        filename = imageElement.attribute("filename");
-        // FIXME: settings
-        settings = filterContainer->dom2Settings(imageElement);
-        appendImageToSide(filename, side, settings);
-        imageElement = imageElement.nextSiblingElement("image");
-        progress++;
     }
-    progressDialog.setValue(numberImages);
+    pageModel->setDefaults(project.projectDefaults(), project.sideDefaults(leftSide),
+                           project.sideDefaults(rightSide));
+    // The overrides of the pages are stamped by setPages()
+    pageModel->setPages(pages[leftSide], pages[rightSide]);
     return true;
 }
 
 // Empty the widget from all images;
 void ImageTableWidget::clear()
 {
-    //FIXME: is memory cleared?
-    ui->images->setRowCount(0);
-    itemCount[leftSide] = 0;
-    itemCount[rightSide] = 0;
+    thumbnailLoader->cancel();
+    pagesMoving = true;
+    pageModel->clear();
+    pagesMoving = false;
 }
 
-void ImageTableWidget::exportToFolder(QString folder)
+/** \brief Sets the icon of all pages showing fileName */
+void ImageTableWidget::setThumbnail(QString fileName, QImage thumbnail)
+{
+    pageModel->setThumbnail(fileName, QIcon(QPixmap::fromImage(thumbnail)));
+}
+
+/** \brief Collects the pages of one side for PageExporter
+
+  The settings of the current item are saved first, so that the last modifications are exported.
+*/
+QList<ExportPage> ImageTableWidget::exportPages(int side)
 {
+    QList<ExportPage> pages;
+    ExportPage page;
     int row;
-    QTableWidgetItem *currentItem = ui->images->currentItem();
-    QPixmap pixmap;
-    QString filename;
 
-    int progress = 0;
-    int maxProgress = itemCount[leftSide] + itemCount[rightSide];
-    QProgressDialog progressDialog(QString("Exporting to folder %2...").arg(folder), "Abort", 0, maxProgress);
-    progressDialog.setWindowModality(Qt::WindowModal);
+    saveCurrentSettings();
 
-    for (row = 0; row < itemCount[leftSide]; row++) {
-        // Update Process Dialog
-        progressDialog.setValue(progress);
-        progress++;
-        if (progressDialog.wasCanceled()) {
-            ui->images->setCurrentItem(currentItem);
-            return;
-        }
-        // Export image
-        ui->images->setCurrentCell(row, leftSide);
-        pixmap = filterContainer->getResultImage();
-        filename = QString("%1/image_%2_Left.jpg").arg(folder).arg(row+1, 3, 10, QChar('0'));
-        pixmap.save(filename);
-    }
-    for (row = 0; row < itemCount[rightSide]; row++) {
-        // Update Process Dialog
-        progressDialog.setValue(progress);
-        progress++;
-        if (progressDialog.wasCanceled()) {
-            ui->images->setCurrentItem(currentItem);
-            return;
-        }
-        // Export image
-        ui->images->setCurrentCell(row, rightSide);
-        pixmap = filterContainer->getResultImage();
-        filename = QString("%1/image_%2_Right.jpg").arg(folder).arg(row+1, 3, 10, QChar('0'));
-        pixmap.save(filename);
+    for (row = 0; row < pageModel->pageCount(side); row++) {
+        page.fileName = pageModel->page(row, side).fileName;
+        page.settings = pageModel->settings(row, side);
+        page.exportName = PageExporter::exportName(row, side == leftSide);
+        pages.append(page);
     }
+    return pages;
+}
+
+/** \brief Exports all pages as jpg into folder.
 
+  maxConcurrentPages pages are computed at the same time (see PageExporter).
+*/
+void ImageTableWidget::exportToFolder(QString folder, int maxConcurrentPages)
+{
+    QList<ExportPage> pages = exportPages(leftSide) + exportPages(rightSide);
+    PageExporter exporter;
+    exporter.setMaxConcurrentPages(maxConcurrentPages);
+
+    int maxProgress = pages.size();
+    QProgressDialog progressDialog(QString("Exporting to folder %2...").arg(folder), "Abort", 0, maxProgress);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    connect(&exporter, SIGNAL(progress(int)), &progressDialog, SLOT(setValue(int)));
+    connect(&progressDialog, SIGNAL(canceled()), &exporter, SLOT(cancel()));
+
+    progressDialog.setValue(0);
+    exporter.exportToFolder(pages, folder);
     progressDialog.setValue(maxProgress);
-    ui->images->setCurrentItem(currentItem);
 }
 
-void ImageTableWidget::exportToPdf(QString pdfFile, int DPI)
+/** \brief Exports all pages into pdfFile, in the order left/right of each row.
+
+  maxConcurrentPages pages are computed at the same time (see PageExporter).
+*/
+void ImageTableWidget::exportToPdf(QString pdfFile, int DPI, int maxConcurrentPages)
 {
-    int row;
-    qreal w = 0;
-    qreal h = 0;
-    bool firstPage = true;
-    QTableWidgetItem *currentItem = ui->images->currentItem();
-    QPixmap pixmap;
-    QPainter painter;
-
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setFullPage(true);
-    printer.setOutputFileName(pdfFile);
-    // This seems to have no effect. Setting it doesn't hurt...
-    printer.setResolution(DPI);
+    QList<ExportPage> pages = PageExporter::interleave(exportPages(leftSide), exportPages(rightSide));
+    PageExporter exporter;
+    exporter.setMaxConcurrentPages(maxConcurrentPages);
 
-    int progress = 0;
-    int maxProgress = qMax(itemCount[leftSide], itemCount[rightSide]);
+    int maxProgress = pages.size();
     QProgressDialog progressDialog(QString("Exporting to %2...").arg(pdfFile), "Abort", 0, maxProgress);
     progressDialog.setWindowModality(Qt::WindowModal);
+    connect(&exporter, SIGNAL(progress(int)), &progressDialog, SLOT(setValue(int)));
+    connect(&progressDialog, SIGNAL(canceled()), &exporter, SLOT(cancel()));
 
-    for (row = 0; row < qMax(itemCount[leftSide], itemCount[rightSide]); row++) {
-        // Update Process Dialog
-        progressDialog.setValue(progress);
-        progress++;
-        if (progressDialog.wasCanceled()) {
-            painter.end();
-            ui->images->setCurrentItem(currentItem);
-            return;
-        }
-        // Export pages
-        // handle both side with one peace of code. side values: 0 = leftSide, 1 = rightSide
-        for (int side = 0; side <= 1; side++) {
-            if (row < itemCount[side]) {       // is one item available at this row?
-                ui->images->setCurrentCell(row, side);
-                pixmap = filterContainer->getResultImage();
-
-                // as QPrinter does not handle DPI right, we have set the paper size in inches.
-                w = (qreal) pixmap.width() / DPI;
-                h = (qreal) pixmap.height() / DPI;
-                printer.setPaperSize(QSizeF(w, h), QPrinter::Inch);
-
-                // we don't need a new page for the first page or we would have a blank page
-                if (firstPage == true) {
-                    firstPage = false;
-                    painter.begin(&printer);
-                } else {
-                    printer.newPage();
-                }
-
-                painter.drawPixmap(printer.pageRect(), pixmap);
-            }
-        }
-    }
-
-    painter.end();
-
+    progressDialog.setValue(0);
+    exporter.exportToPdf(pages, pdfFile, DPI);
     progressDialog.setValue(maxProgress);
-    ui->images->setCurrentItem(currentItem);
 }
 
 
 
 
+/** \brief Sets the current filter of the current and following pages of the side
+
+  From the first page, this is the same as setting the defaults of the side.
+*/
 void ImageTableWidget::on_btnPropagateFollowingSameSide_clicked()
 {
-    QMap<QString, QVariant> filterSettings;
-    int row = ui->images->currentRow();
-    int side = ui->images->currentColumn();
+    int row = ui->images->currentIndex().row();
+    int side = ui->images->currentIndex().column();
+
+    if (!pageModel->hasPage(row, side))
+        return;
+    if (row == 0) {
+        on_btnPropagateAllSameSide_clicked();
+        return;
+    }
 
     QMap<QString, QVariant> settings = filterContainer->getSettings();
     QString filterID = filterContainer->currentFilter();
-    for (int i = row; i < itemCount[side]; i++) {
-        filterSettings = ui->images->item(i, side)->data(ImagePreferences).toMap();
-        filterSettings[filterID] = settings[filterID];
-        ui->images->item(i, side)->setData(ImagePreferences, filterSettings);
+    for (int i = row; i < pageModel->pageCount(side); i++) {
+        pageModel->setPageFilter(i, side, filterID, settings[filterID]);
     }
 }
 
 
+/** \brief Sets the current filter as default of the side: the overrides of the pages are superseded */
 void ImageTableWidget::on_btnPropagateAllSameSide_clicked()
 {
-    QMap<QString, QVariant> filterSettings;
-    int side = ui->images->currentColumn();
+    int side = ui->images->currentIndex().column();
+
+    if (side < 0)
+        return;
 
     QMap<QString, QVariant> settings = filterContainer->getSettings();
     QString filterID = filterContainer->currentFilter();
-    for (int i = 0; i < itemCount[side]; i++) {
-        filterSettings = ui->images->item(i, side)->data(ImagePreferences).toMap();
-        filterSettings[filterID] = settings[filterID];
-        ui->images->item(i, side)->setData(ImagePreferences, filterSettings);
-    }
+    pageModel->setSideFilter(side, filterID, settings[filterID]);
 }
 
+/** \brief Sets the current filter as default of the project */
 void ImageTableWidget::on_btnPropagateAll_clicked()
 {
-    QMap<QString, QVariant> filterSettings;
-
-    for (int side=0; side <= 1; side++) {
-        QMap<QString, QVariant> settings = filterContainer->getSettings();
-        QString filterID = filterContainer->currentFilter();
-        for (int i = 0; i < itemCount[side]; i++) {
-            filterSettings = ui->images->item(i, side)->data(ImagePreferences).toMap();
-            filterSettings[filterID] = settings[filterID];
-            ui->images->item(i, side)->setData(ImagePreferences, filterSettings);
-        }
-    }
+    QMap<QString, QVariant> settings = filterContainer->getSettings();
+    QString filterID = filterContainer->currentFilter();
+    pageModel->setProjectFilter(filterID, settings[filterID]);
 }
-
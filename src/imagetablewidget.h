@@ -21,9 +21,13 @@
 #define IMAGETABLEWIDGET_H
 
 #include <QWidget>
-#include <QTableWidgetItem>
-#include <QtXml/QDomDocument>
+#include <QModelIndex>
 #include "filtercontainer.h"
+#include "pageexporter.h"
+#include "pagemodel.h"
+#include "projectreader.h"
+#include "projectwriter.h"
+#include "thumbnailloader.h"
 
 namespace Ui {
 class ImageTableWidget;
@@ -38,15 +42,15 @@ public:
     ~ImageTableWidget();
     void setFilterContainer(FilterContainer *container);
     // save YASW into XML
-    void saveProjectParameters(QDomDocument &doc, QDomElement &parent);
+    void saveProjectParameters(ProjectWriter &project);
     // load XML int YASW
-    bool loadProjectParameters(QDomElement &rootElement);
+    bool loadProjectParameters(ProjectReader &project);
     void clear();
-    void exportToFolder(QString folder);
-    void exportToPdf(QString pdfFile, int DPI);
+    void exportToFolder(QString folder, int maxConcurrentPages);
+    void exportToPdf(QString pdfFile, int DPI, int maxConcurrentPages);
 
 public slots:
-    void currentItemChanged(QTableWidgetItem *newItem, QTableWidgetItem *previousItem);
+    void currentPageChanged(const QModelIndex &current, const QModelIndex &previous);
     void insertImage();
     void insertEmptyImage();
     void imageUp();
@@ -63,22 +67,23 @@ private:
     Ui::ImageTableWidget *ui;
     enum ImageSide { leftSide, rightSide };
     FilterContainer *filterContainer;
+    PageModel *pageModel;
     QString lastDir = "";
-    // stores the last row for left and right images
-    int itemCount[2];
+    // true while pages are moved in pageModel: the current page is then selected by selectMovedPage()
+    bool pagesMoving = false;
+    ThumbnailLoader *thumbnailLoader;
 
     void addImage(QString fileName, enum ImageSide side,
                   QMap<QString, QVariant> settings = QMap<QString, QVariant> ());
-    void appendImageToSide(QString fileName, ImageTableWidget::ImageSide side,
-                           QMap<QString, QVariant> settings);
-    enum ImageTableUserRoles { ImagePreferences = Qt::UserRole,
-                              ImageFileName
-                            };
-    void addClicked(ImageTableWidget::ImageSide side);
-    QTableWidgetItem * takeItem(int row, int side);
-    void insertItem(QTableWidgetItem * item, int row, int side);
+    void saveCurrentSettings();
+    void beginMovePages();
+    void selectMovedPage(int row, int side);
+    void showPage(const QModelIndex &current, const QModelIndex &previous);
+    QList<ExportPage> exportPages(int side);
+    void prefetchNeighbours(const QModelIndex &current, const QModelIndex &previous);
 
 private slots:
+    void setThumbnail(QString fileName, QImage thumbnail);
     void on_btnPropagateFollowingSameSide_clicked();
     void on_btnPropagateAllSameSide_clicked();
     void on_btnPropagateAll_clicked();
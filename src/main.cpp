@@ -17,12 +17,34 @@
  * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QApplication>
+#include <QCoreApplication>
 #include "mainwindow.h"
+#include "batchexport.h"
+#include "constants.h"
+#include "stagelog.h"
+#include "framepool.h"
 
 int main(int argc, char *argv[])
 {
+    // Opt-in log of the time spent in each stage of each page
+    StageLog::globalInstance()->openDefaultLog();
+
+    // Export without GUI (see BatchExport): no QApplication, so no display is needed.
+    if (BatchExport::isBatchMode(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        QCoreApplication::setApplicationName("yasw");
+        QCoreApplication::setApplicationVersion(VERSION);
+        BatchExport batchExport;
+        int exitCode = batchExport.run(app.arguments());
+        // Memory used by each stage over the whole run
+        FramePool::globalInstance()->logStatistics();
+        return exitCode;
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
-    return a.exec();
+    int exitCode = a.exec();
+    FramePool::globalInstance()->logStatistics();
+    return exitCode;
 }
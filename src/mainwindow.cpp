@@ -24,10 +24,10 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QColor>
-#include <QtXml/QDomDocument>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "constants.h"
+#include "stagelog.h"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -59,6 +59,9 @@ MainWindow::MainWindow(QWidget *parent) :
 
 
     preferencesDialog->setSettings(settings);
+
+    connect(StageLog::globalInstance(), SIGNAL(timingsChanged(QString)),
+            ui->statusBar, SLOT(showMessage(QString)));
 }
 
 MainWindow::~MainWindow()
@@ -117,8 +120,12 @@ void MainWindow::on_action_SaveAs_triggered()
   */
 bool MainWindow::saveProjectSettings(QString fileName)
 {
-    QFile file(fileName);
-    if (!file.open(QFile::WriteOnly | QFile::Text)) {
+    ProjectWriter project;
+
+    preferencesDialog->saveProjectParameters(project);
+    ui->imageList->saveProjectParameters(project);
+
+    if (!project.save(fileName)) {
         // Failure
         QMessageBox::critical(this,
             tr("Could not save Project"),
@@ -128,18 +135,6 @@ bool MainWindow::saveProjectSettings(QString fileName)
         return false;
     }
 
-    QDomDocument doc;
-    QDomElement yasw = doc.createElement("yasw");
-    doc.appendChild(yasw);
-    yasw.setAttribute("version", VERSION);
-
-    preferencesDialog->saveProjectParameters(doc, yasw);
-    ui->imageList->saveProjectParameters(doc, yasw);
-
-    QTextStream out(&file);
-    doc.save(out, 4);
-    file.close();
-
     return true;
 }
 /* \Brief Sets the current project name in the title bar and inserts it to the recent projects.
@@ -199,43 +194,17 @@ void MainWindow::loadProject(QString fileName)
     QMap<QString, QVariant> settings;
     bool loadingOK = true;
 
-    QFile file(fileName);
-    if (!file.open(QFile::ReadOnly | QFile::Text)) {
-        // Failure
-        QMessageBox::critical(this,
-            tr("Could not load Project"),
-            tr("A problem occured while loading file \"%1\"")
-                          .arg(fileName)
-                              );
-        return;
-    }
-
-    QDomDocument doc;
-    QString errMsg;
-    int errLine, errColumn;
-    if (!doc.setContent(&file, false, &errMsg, &errLine, &errColumn)) {
+    ProjectReader project;
+    if (!project.load(fileName)) {
         QMessageBox::critical(this,
                               tr("Could not load Project"),
-                              tr("A problem occured while parsing file \"%1\" :\n"
-                                 "Line %2, Column %3: %4")
-                              .arg(fileName, QString::number(errLine),
-                                   QString::number(errColumn), errMsg));
-        return;
-    }
-
-    QDomElement rootElement = doc.documentElement();
-    if (rootElement.tagName() != "yasw") {
-        QMessageBox::critical(this,
-            tr("Could not load Project"),
-            tr("\"%1\" is not a valid YASW project file")
-                          .arg(fileName)
-                              );
+                              project.errorString());
         return;
     }
 
     // if loadingError is true, the function after || will not be called.
-    loadingOK = loadingOK && preferencesDialog->loadProjectParameters(rootElement);
-    loadingOK = loadingOK && ui->imageList->loadProjectParameters(rootElement);
+    loadingOK = loadingOK && preferencesDialog->loadProjectParameters(project);
+    loadingOK = loadingOK && ui->imageList->loadProjectParameters(project);
     if (loadingOK) {
         setProjectFileName(fileName);
     } else {
@@ -274,7 +243,7 @@ void MainWindow::exportToJpeg()
     if (exportFolder.length() == 0)
         return;
 
-    ui->imageList->exportToFolder(exportFolder);
+    ui->imageList->exportToFolder(exportFolder, preferencesDialog->exportPages());
 }
 
 void MainWindow::exportToPdf()
@@ -293,7 +262,7 @@ void MainWindow::exportToPdf()
     if (exportFile.length() == 0)
         return;
 
-    ui->imageList->exportToPdf(exportFile, preferencesDialog->DPI());
+    ui->imageList->exportToPdf(exportFile, preferencesDialog->DPI(), preferencesDialog->exportPages());
 }
 
 /** \brief Close curent project,
@@ -328,6 +297,14 @@ void MainWindow::on_action_About_triggered()
                           "YASW uses icons from the Tango Theme, which is in the public domain."));
 }
 
+void MainWindow::on_actionMemory_statistics_triggered()
+{
+    if (!memoryStatisticsDialog)
+        memoryStatisticsDialog = new MemoryStatisticsDialog(this);
+    memoryStatisticsDialog->show();
+    memoryStatisticsDialog->raise();
+}
+
 void MainWindow::openRecentProject()
 {
     QAction *action = qobject_cast<QAction *>(sender());
@@ -25,6 +25,7 @@
 #include <QGraphicsPixmapItem>
 #include <QSettings>
 #include "preferencesdialog.h"
+#include "memorystatisticsdialog.h"
 
 namespace Ui {
     class MainWindow;
@@ -49,6 +50,7 @@ private slots:
     void exportToPdf();
 
     void on_action_About_triggered();
+    void on_actionMemory_statistics_triggered();
 
     void openRecentProject();
 
@@ -66,6 +68,7 @@ private:
     QSettings *settings = NULL;
     const int MAX_RECENT_PROJECTS = 5;
     PreferencesDialog *preferencesDialog;
+    MemoryStatisticsDialog *memoryStatisticsDialog = NULL;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorystatisticsdialog.h"
+#include "framepool.h"
+#include "imagecache.h"
+
+#include <QVBoxLayout>
+#include <QHeaderView>
+
+// Formats bytes in MB, with one decimal
+static QString megabytes(qint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1);
+}
+
+MemoryStatisticsDialog::MemoryStatisticsDialog(QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Memory statistics"));
+
+    totals = new QLabel(this);
+    table = new QTableWidget(0, 5, this);
+    table->setHorizontalHeaderLabels(QStringList() << tr("Stage") << tr("Live (MB)") << tr("Peak (MB)")
+                                     << tr("Allocations") << tr("Reused"));
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->verticalHeader()->hide();
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(totals);
+    layout->addWidget(table);
+
+    timer.setInterval(1000);
+    connect(&timer, SIGNAL(timeout()),
+            this, SLOT(updateStatistics()));
+}
+
+void MemoryStatisticsDialog::showEvent(QShowEvent *event)
+{
+    updateStatistics();
+    timer.start();
+    QDialog::showEvent(event);
+}
+
+void MemoryStatisticsDialog::hideEvent(QHideEvent *event)
+{
+    timer.stop();
+    QDialog::hideEvent(event);
+}
+
+void MemoryStatisticsDialog::updateStatistics()
+{
+    FramePool *pool = FramePool::globalInstance();
+    QMap<QString, FrameStatistics> statistics = pool->statistics();
+    int row = 0;
+
+    totals->setText(tr("Images: %1 MB (peak %2 MB), unused buffers: %3 MB, cache limit: %4 MB")
+                    .arg(megabytes(pool->liveBytes()))
+                    .arg(megabytes(pool->peakBytes()))
+                    .arg(megabytes(pool->pooledBytes()))
+                    .arg(ImageCache::globalInstance()->maxSize()));
+
+    table->setRowCount(statistics.size());
+    foreach (QString stage, statistics.keys()) {
+        const FrameStatistics &stageStatistics = statistics[stage];
+        table->setItem(row, 0, new QTableWidgetItem(stage));
+        table->setItem(row, 1, new QTableWidgetItem(megabytes(stageStatistics.liveBytes)));
+        table->setItem(row, 2, new QTableWidgetItem(megabytes(stageStatistics.peakBytes)));
+        table->setItem(row, 3, new QTableWidgetItem(QString::number(stageStatistics.allocations)));
+        table->setItem(row, 4, new QTableWidgetItem(QString::number(stageStatistics.reused)));
+        row++;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MEMORYSTATISTICSDIALOG_H
+#define MEMORYSTATISTICSDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTimer>
+
+/* Shows the memory used by the images of each stage (see FramePool), refreshed every second.
+   This is a debugging help: it is opened from the Help menu. */
+class MemoryStatisticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MemoryStatisticsDialog(QWidget *parent = 0);
+
+protected:
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
+
+private slots:
+    void updateStatistics();
+
+private:
+    QLabel *totals;
+    QTableWidget *table;
+    QTimer timer;
+};
+
+#endif // MEMORYSTATISTICSDIALOG_H
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pagemodel.h"
+
+#include <QFileInfo>
+#include <QVector>
+
+// Thumbnails set within this delay are shown with one repaint of the view.
+static const int THUMBNAIL_BATCH_MS = 100;
+
+void SettingsLayer::set(QString identifier, const QVariant &filterSettings, quint64 stamp)
+{
+    settings[identifier] = filterSettings;
+    stamps[identifier] = stamp;
+}
+
+void SettingsLayer::remove(QString identifier)
+{
+    settings.remove(identifier);
+    stamps.remove(identifier);
+}
+
+PageModel::PageModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+    thumbnailTimer.setSingleShot(true);
+    thumbnailTimer.setInterval(THUMBNAIL_BATCH_MS);
+    connect(&thumbnailTimer, SIGNAL(timeout()), this, SLOT(thumbnailsChanged()));
+}
+
+int PageModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return qMax(sides[0].size(), sides[1].size());
+}
+
+int PageModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return 2;
+}
+
+QVariant PageModel::data(const QModelIndex &index, int role) const
+{
+    if (!hasPage(index.row(), index.column()))
+        return QVariant();
+
+    const ProjectPage &page = sides[index.column()].at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return QFileInfo(page.fileName).fileName();
+    case Qt::ToolTipRole:
+        return page.fileName;
+    case Qt::DecorationRole:
+        return thumbnails.value(page.fileName);
+    }
+    return QVariant();
+}
+
+QVariant PageModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return section == 0 ? tr("Left") : tr("Right");
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/** \brief Empty cells (below the end of the shorter side) can not be selected */
+Qt::ItemFlags PageModel::flags(const QModelIndex &index) const
+{
+    if (!hasPage(index.row(), index.column()))
+        return Qt::NoItemFlags;
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+}
+
+int PageModel::pageCount(int side) const
+{
+    return sides[side].size();
+}
+
+bool PageModel::hasPage(int row, int side) const
+{
+    return side >= 0 && side <= 1 && row >= 0 && row < sides[side].size();
+}
+
+/** \brief The page at row and side; hasPage(row, side) must be true */
+const ProjectPage &PageModel::page(int row, int side) const
+{
+    return sides[side].at(row);
+}
+
+/** \brief Settings of all filters of a page (see FilterContainer::setPage()) */
+QMap<QString, QVariant> PageModel::settings(int row, int side) const
+{
+    SettingsLayer inherited = resolve(projectLayer, sideLayers[side]);
+    return resolve(inherited, sides[side].at(row).overrides).settings;
+}
+
+/** \brief Stores the settings of a page, as returned by FilterContainer::getSettings().
+
+  Only the filters that differ from the defaults are kept for this page.
+*/
+void PageModel::setSettings(int row, int side, const QMap<QString, QVariant> &settings)
+{
+    if (!hasPage(row, side))
+        return;
+
+    SettingsLayer inherited = resolve(projectLayer, sideLayers[side]);
+    SettingsLayer &overrides = sides[side][row].overrides;
+    QString identifier;
+
+    foreach (identifier, settings.keys()) {
+        const QVariant &filterSettings = settings[identifier];
+        bool pageWins = overrides.stamps.contains(identifier)
+                && overrides.stamps[identifier] > inherited.stamps.value(identifier, 0);
+
+        if (inherited.settings.contains(identifier) && inherited.settings[identifier] == filterSettings)
+            overrides.remove(identifier);
+        else if (!pageWins || overrides.settings[identifier] != filterSettings)
+            overrides.set(identifier, filterSettings, ++stamp);
+    }
+}
+
+void PageModel::setPageFilter(int row, int side, QString identifier, const QVariant &filterSettings)
+{
+    if (hasPage(row, side))
+        sides[side][row].overrides.set(identifier, filterSettings, ++stamp);
+}
+
+/** \brief Sets the settings of a filter for all pages of side */
+void PageModel::setSideFilter(int side, QString identifier, const QVariant &filterSettings)
+{
+    sideLayers[side].set(identifier, filterSettings, ++stamp);
+}
+
+/** \brief Sets the settings of a filter for all pages */
+void PageModel::setProjectFilter(QString identifier, const QVariant &filterSettings)
+{
+    projectLayer.set(identifier, filterSettings, ++stamp);
+    // The side defaults are older now; forget them so that they are not saved
+    sideLayers[0].remove(identifier);
+    sideLayers[1].remove(identifier);
+}
+
+QMap<QString, QVariant> PageModel::projectDefaults() const
+{
+    return projectLayer.settings;
+}
+
+/** \brief Defaults of side that are newer than the project defaults */
+QMap<QString, QVariant> PageModel::sideDefaults(int side) const
+{
+    return newerSettings(sideLayers[side], projectLayer);
+}
+
+/** \brief Settings of the page that are newer than the defaults (what has to be saved for the page) */
+QMap<QString, QVariant> PageModel::pageOverrides(int row, int side) const
+{
+    return newerSettings(sides[side].at(row).overrides, resolve(projectLayer, sideLayers[side]));
+}
+
+/** \brief Sets the defaults of a loaded project. Call before setPages(). */
+void PageModel::setDefaults(const QMap<QString, QVariant> &projectDefaults,
+                            const QMap<QString, QVariant> &leftDefaults,
+                            const QMap<QString, QVariant> &rightDefaults)
+{
+    projectLayer = stamped(projectDefaults, ++stamp);
+    stamp++;
+    sideLayers[0] = stamped(leftDefaults, stamp);
+    sideLayers[1] = stamped(rightDefaults, stamp);
+}
+
+/** \brief Replaces all pages. The overrides of the pages are set after the defaults. */
+void PageModel::setPages(const QList<ProjectPage> &leftPages, const QList<ProjectPage> &rightPages)
+{
+    int side, row;
+
+    beginResetModel();
+    sides[0] = leftPages;
+    sides[1] = rightPages;
+    stamp++;
+    for (side = 0; side <= 1; side++) {
+        for (row = 0; row < sides[side].size(); row++)
+            sides[side][row].overrides = stamped(sides[side][row].overrides.settings, stamp);
+    }
+    endResetModel();
+}
+
+/** \brief Inserts page before row on side; row is bounded to the existing pages */
+void PageModel::insertPage(int row, int side, const ProjectPage &page)
+{
+    int rows = rowCount();
+    bool newRow = sides[side].size() == rows;
+
+    row = qBound(0, row, sides[side].size());
+
+    if (newRow)
+        beginInsertRows(QModelIndex(), rows, rows);
+    sides[side].insert(row, page);
+    if (newRow)
+        endInsertRows();
+
+    // The following pages of this side moved one row down
+    emit dataChanged(index(row, side), index(sides[side].size() - 1, side));
+}
+
+/** \brief Removes the page at row and side and returns it; hasPage(row, side) must be true */
+ProjectPage PageModel::takePage(int row, int side)
+{
+    int rows = rowCount();
+    bool lastRow = sides[side].size() == rows && sides[1 - side].size() < rows;
+
+    if (lastRow)
+        beginRemoveRows(QModelIndex(), rows - 1, rows - 1);
+    ProjectPage page = sides[side].takeAt(row);
+    if (lastRow)
+        endRemoveRows();
+
+    // The following pages of this side moved one row up
+    if (row < sides[side].size())
+        emit dataChanged(index(row, side), index(sides[side].size() - 1, side));
+    return page;
+}
+
+void PageModel::swapPages(int row, int otherRow, int side)
+{
+    if (!hasPage(row, side) || !hasPage(otherRow, side))
+        return;
+
+    sides[side].swap(row, otherRow);
+    emit dataChanged(index(row, side), index(row, side));
+    emit dataChanged(index(otherRow, side), index(otherRow, side));
+}
+
+void PageModel::clear()
+{
+    setPages(QList<ProjectPage>(), QList<ProjectPage>());
+    projectLayer = SettingsLayer();
+    sideLayers[0] = SettingsLayer();
+    sideLayers[1] = SettingsLayer();
+    thumbnails.clear();
+}
+
+/** \brief The filters of upper replace those of lower when they were set later */
+SettingsLayer PageModel::resolve(const SettingsLayer &lower, const SettingsLayer &upper)
+{
+    SettingsLayer resolved = lower;
+    QString identifier;
+
+    foreach (identifier, upper.stamps.keys()) {
+        if (upper.stamps[identifier] > resolved.stamps.value(identifier, 0))
+            resolved.set(identifier, upper.settings[identifier], upper.stamps[identifier]);
+    }
+    return resolved;
+}
+
+/** \brief The filter settings of layer that were set after those of lower */
+QMap<QString, QVariant> PageModel::newerSettings(const SettingsLayer &layer, const SettingsLayer &lower)
+{
+    QMap<QString, QVariant> newer;
+    QString identifier;
+
+    foreach (identifier, layer.stamps.keys()) {
+        if (layer.stamps[identifier] > lower.stamps.value(identifier, 0))
+            newer[identifier] = layer.settings[identifier];
+    }
+    return newer;
+}
+
+SettingsLayer PageModel::stamped(const QMap<QString, QVariant> &settings, quint64 layerStamp)
+{
+    SettingsLayer layer;
+    QString identifier;
+
+    foreach (identifier, settings.keys())
+        layer.set(identifier, settings[identifier], layerStamp);
+    return layer;
+}
+
+/** \brief Sets the icon shown for all the pages of the image fileName.
+
+  The pages are not searched: the view is updated once for all the thumbnails set
+  within THUMBNAIL_BATCH_MS.
+*/
+void PageModel::setThumbnail(QString fileName, QIcon thumbnail)
+{
+    thumbnails[fileName] = thumbnail;
+    if (!thumbnailTimer.isActive())
+        thumbnailTimer.start();
+}
+
+// The view only repaints the cells that are visible.
+void PageModel::thumbnailsChanged()
+{
+    if (rowCount() > 0)
+        emit dataChanged(index(0, 0), index(rowCount() - 1, 1), QVector<int>() << Qt::DecorationRole);
+}
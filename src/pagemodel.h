@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+ *
+ * This file is part of YASW (Yet Another Scan Wizard).
+ *
+ * YASW is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YASW is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PAGEMODEL_H
+#define PAGEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QIcon>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+
+/* Settings of some filters (filter identifier -> settings of this filter), each with the
+   moment it was set. See PageModel::settings(). */
+struct SettingsLayer
+{
+    QMap<QString, QVariant> settings;
+    QMap<QString, quint64> stamps;
+
+    void set(QString identifier, const QVariant &filterSettings, quint64 stamp);
+    void remove(QString identifier);
+};
+
+/* One scanned page of the project: the image and the filter settings set for this page only */
+struct ProjectPage
+{
+    QString fileName;
+    SettingsLayer overrides;
+};
+
+/* Pages of the project, shown by ImageTableWidget.
+
+  Column 0 holds the left pages and column 1 the right pages; both sides are independent
+  lists, so a side may be longer than the other one. Pages are accessed by (row, side)
+  in constant time. Inserting, removing or moving a page only shifts the list of pointers
+  of its side and updates the cells of the view that are visible.
+
+  The settings of a page are layered: the project defaults, the defaults of its side and the
+  settings overridden for this page. For every filter, the layer where it was set last wins,
+  so propagating a filter to all pages (of a side) changes one layer only. Pages keep
+  their own settings only for the filters that differ from the defaults.
+
+  Thumbnails are stored by file name, as an image may be used by several pages. The
+  thumbnails decoded in the background arrive one by one: the view is told about them in
+  batches (see THUMBNAIL_BATCH_MS), as it only repaints its visible cells anyway.
+*/
+class PageModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit PageModel(QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+
+    int pageCount(int side) const;
+    bool hasPage(int row, int side) const;
+    const ProjectPage &page(int row, int side) const;
+
+    QMap<QString, QVariant> settings(int row, int side) const;
+    void setSettings(int row, int side, const QMap<QString, QVariant> &settings);
+    void setPageFilter(int row, int side, QString identifier, const QVariant &filterSettings);
+    void setSideFilter(int side, QString identifier, const QVariant &filterSettings);
+    void setProjectFilter(QString identifier, const QVariant &filterSettings);
+
+    QMap<QString, QVariant> projectDefaults() const;
+    QMap<QString, QVariant> sideDefaults(int side) const;
+    QMap<QString, QVariant> pageOverrides(int row, int side) const;
+    void setDefaults(const QMap<QString, QVariant> &projectDefaults,
+                     const QMap<QString, QVariant> &leftDefaults,
+                     const QMap<QString, QVariant> &rightDefaults);
+    void setPages(const QList<ProjectPage> &leftPages, const QList<ProjectPage> &rightPages);
+    void insertPage(int row, int side, const ProjectPage &page);
+    ProjectPage takePage(int row, int side);
+    void swapPages(int row, int otherRow, int side);
+    void clear();
+
+    void setThumbnail(QString fileName, QIcon thumbnail);
+
+private slots:
+    void thumbnailsChanged();
+
+private:
+    static SettingsLayer resolve(const SettingsLayer &lower, const SettingsLayer &upper);
+    static QMap<QString, QVariant> newerSettings(const SettingsLayer &layer, const SettingsLayer &lower);
+    static SettingsLayer stamped(const QMap<QString, QVariant> &settings, quint64 layerStamp);
+
+    QList<ProjectPage> sides[2];
+    SettingsLayer projectLayer;
+    SettingsLayer sideLayers[2];
+    // Increased each time settings are set
+    quint64 stamp = 0;
+    QHash<QString, QIcon> thumbnails;
+    // Runs while thumbnails wait to be shown
+    QTimer thumbnailTimer;
+};
+
+#endif // PAGEMODEL_H
@@ -25,6 +25,8 @@
 #include "preferencesdialog.h"
 #include "ui_preferencesdialog.h"
 #include "constants.h"
+#include "pageexporter.h"
+#include "imagecache.h"
 
 PreferencesDialog::PreferencesDialog(QWidget *parent) :
     QDialog(parent),
@@ -47,6 +49,9 @@ PreferencesDialog::PreferencesDialog(QWidget *parent) :
 
     ui->dpi->insertItems(0, Constants::dpiList);
     setDPI(Constants::DEFAULT_DPI);
+
+    ui->exportPages->setValue(PageExporter::defaultConcurrentPages());
+    ui->cacheSize->setValue(ImageCache::defaultMaxSize());
 }
 
 PreferencesDialog::~PreferencesDialog()
@@ -73,6 +78,10 @@ void PreferencesDialog::setSettings(QSettings *newSettings)
 
     QString unit = settings->value("displayUnit").toString();
     setDisplayUnit(unit);
+
+    ui->exportPages->setValue(settings->value("exportPages",
+                                              PageExporter::defaultConcurrentPages()).toInt());
+    ui->cacheSize->setValue(settings->value("cacheSize", ImageCache::defaultMaxSize()).toInt());
 }
 
 QString PreferencesDialog::displayUnit()
@@ -102,19 +111,20 @@ int PreferencesDialog::DPI()
     return dpi;
 }
 
-void PreferencesDialog::saveProjectParameters(QDomDocument &doc, QDomElement &rootElement)
+/** \brief Number of pages computed at the same time while exporting */
+int PreferencesDialog::exportPages()
+{
+    return ui->exportPages->value();
+}
+
+void PreferencesDialog::saveProjectParameters(ProjectWriter &project)
 {
-    QDomElement parameter = doc.createElement("global");
-    parameter.setAttribute("DPI", dpi);
-    rootElement.appendChild(parameter);
+    project.setDPI(dpi);
 }
 
-bool PreferencesDialog::loadProjectParameters(QDomElement &rootElement)
+bool PreferencesDialog::loadProjectParameters(ProjectReader &project)
 {
-    QDomElement parameter = rootElement.firstChildElement("global");
-    if (parameter.isNull())
-        return false;
-    setDPI(parameter.attribute("DPI", QString::number(Constants::DEFAULT_DPI, 'f', 0)).toInt());
+    setDPI(project.DPI());
     return true;
 }
 
@@ -218,6 +228,22 @@ void PreferencesDialog::on_dpi_editTextChanged(const QString &stringDPI)
     }
 }
 
+void PreferencesDialog::on_exportPages_valueChanged(int pages)
+{
+    if (settings) {
+        settings->setValue("exportPages", pages);
+    }
+}
+
+/** \brief Sets the memory budget of the cache of computed pages */
+void PreferencesDialog::on_cacheSize_valueChanged(int megabytes)
+{
+    ImageCache::globalInstance()->setMaxSize(megabytes);
+    if (settings) {
+        settings->setValue("cacheSize", megabytes);
+    }
+}
+
 void PreferencesDialog::dpiFormChanged()
 {
     int newDPI = ui->dpi->currentText().toInt();
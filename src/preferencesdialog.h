@@ -22,9 +22,9 @@
 #include <QDialog>
 #include <QColor>
 #include <QSettings>
-#include <QDomDocument>
-#include <QDomElement>
 #include <QKeyEvent>
+#include "projectreader.h"
+#include "projectwriter.h"
 
 namespace Ui {
 class PreferencesDialog;
@@ -41,11 +41,12 @@ public:
     QString displayUnit();
     void setDPI(int newDpi);
     int DPI();
+    int exportPages();
 
     // save YASW into XML
-    void saveProjectParameters(QDomDocument &doc, QDomElement &rootElement);
+    void saveProjectParameters(ProjectWriter &project);
     // load XML int YASW
-    bool loadProjectParameters(QDomElement &rootElement);
+    bool loadProjectParameters(ProjectReader &project);
     void keyPressEvent(QKeyEvent *evt);
 
 public slots:
@@ -56,6 +57,8 @@ private slots:
     void on_backgroundColorButton_clicked();
     void on_unit_currentIndexChanged(const QString &unit);
     void on_dpi_editTextChanged(const QString &stringDPI);
+    void on_exportPages_valueChanged(int pages);
+    void on_cacheSize_valueChanged(int megabytes);
 
 
 private:
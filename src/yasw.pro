@@ -20,10 +20,9 @@
 QMAKE_CXXFLAGS += -std=c++11
 TARGET = yasw
 TEMPLATE = app
-QT += xml
 QT += widgets
-QT += printsupport
 SOURCES += main.cpp \
+    batchexport.cpp \
     mainwindow.cpp \
     filter/basefilter.cpp \
     filter/basefiltergraphicsview.cpp \
@@ -41,18 +40,20 @@ SOURCES += main.cpp \
     filter/dekeystoning/dekeystoningline.cpp \
     filter/dekeystoning/dekeystoningcorner.cpp \
     imagetablewidget.cpp \
+    pagemodel.cpp \
     filter/scalewidget.cpp \
     preferencesdialog.cpp \
+    memorystatisticsdialog.cpp \
     filter/colorcorrectionwidget.cpp \
     filter/colorcorrection.cpp \
     filter/dekeystoning/dekeystoninggraphicsview.cpp \
     filter/colorcorrectiongraphicsview.cpp \
     filter/colorcorrectiongraphicsscene.cpp \
-    constants.cpp \
     filter/layoutfilter.cpp \
     filter/layoutwidget.cpp \
     filter/scalefilter.cpp
 HEADERS += mainwindow.h \
+    batchexport.h \
     filter/basefilter.h \
     filter/basefiltergraphicsview.h \
     filter/basefilterwidget.h \
@@ -70,15 +71,16 @@ HEADERS += mainwindow.h \
     filter/dekeystoning/dekeystoningline.h \
     filter/dekeystoning/dekeystoningcorner.h \
     imagetablewidget.h \
+    pagemodel.h \
     filter/scalewidget.h \
     filter/layoutfilter.h \
     filter/layoutwidget.h \
     preferencesdialog.h \
+    memorystatisticsdialog.h \
     filter/colorcorrectionwidget.h \
     filter/colorcorrection.h \
     filter/colorcorrectiongraphicsview.h \
     filter/colorcorrectiongraphicsscene.h \
-    constants.h \
     filter/scalefilter.h
 FORMS += mainwindow.ui \
     filter/basefilterwidget.ui \
@@ -96,6 +98,8 @@ INCLUDEPATH += filter \
     filter/cropping
 RESOURCES += icons/icons.qrc
 
+include(engine/engine.pri)
+
 OTHER_FILES += \
     ../changelog.txt \
     ../install.txt \
@@ -0,0 +1,23 @@
+# Copyright (C) 2014 Robert Chéramy (robert@cheramy.net)
+# 
+# This file is part of YASW (Yet Another Scan Wizard).
+# 
+# YASW is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# 
+# YASW is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with YASW.  If not, see <http://www.gnu.org/licenses/>.
+
+# Builds the application and the benchmark (see bench/filterbenchmark.h).
+# The application alone is still built from src/yasw.pro.
+TEMPLATE = subdirs
+SUBDIRS = app bench
+app.file = src/yasw.pro
+bench.file = bench/bench.pro